@@ -0,0 +1,401 @@
+#include "AabbTree.h"
+
+#include <algorithm>
+
+using namespace std;
+
+template <typename Scalar>
+bool Aabb<Scalar>::contains(const Aabb& other) const
+{
+    return this->minX <= other.minX && this->minY <= other.minY && other.maxX <= this->maxX && other.maxY <= this->maxY;
+}
+
+template <typename Scalar>
+bool Aabb<Scalar>::overlaps(const Aabb& other) const
+{
+    return this->minX <= other.maxX && other.minX <= this->maxX && this->minY <= other.maxY && other.minY <= this->maxY;
+}
+
+template <typename Scalar>
+Scalar Aabb<Scalar>::perimeter() const
+{
+    return 2 * (this->maxX - this->minX + this->maxY - this->minY);
+}
+
+template <typename Scalar>
+Aabb<Scalar> Aabb<Scalar>::merge(const Aabb& first, const Aabb& second)
+{
+    Aabb box;
+
+    box.minX = min(first.minX, second.minX);
+    box.minY = min(first.minY, second.minY);
+    box.maxX = max(first.maxX, second.maxX);
+    box.maxY = max(first.maxY, second.maxY);
+
+    return box;
+}
+
+template <typename Scalar>
+void AabbTree<Scalar>::clear()
+{
+    this->nodes.clear();
+
+    this->root = -1;
+    this->firstFreeNode = -1;
+}
+
+template <typename Scalar>
+int AabbTree<Scalar>::createProxy(const Aabb<Scalar>& box, Scalar margin, int userId)
+{
+    int leaf = this->allocateNode();
+
+    Node& node = this->nodes[leaf];
+
+    node.box = { box.minX - margin, box.minY - margin, box.maxX + margin, box.maxY + margin };
+    node.userId = userId;
+
+    this->insertLeaf(leaf);
+
+    return leaf;
+}
+
+template <typename Scalar>
+void AabbTree<Scalar>::destroyProxy(int proxy)
+{
+    this->removeLeaf(proxy);
+    this->freeNode(proxy);
+}
+
+template <typename Scalar>
+bool AabbTree<Scalar>::moveProxy(int proxy, const Aabb<Scalar>& box, Scalar margin)
+{
+    if (this->nodes[proxy].box.contains(box))
+        return false;
+
+    this->removeLeaf(proxy);
+
+    this->nodes[proxy].box = { box.minX - margin, box.minY - margin, box.maxX + margin, box.maxY + margin };
+
+    this->insertLeaf(proxy);
+
+    this->reinsertions++;
+
+    return true;
+}
+
+template <typename Scalar>
+void AabbTree<Scalar>::query(const Aabb<Scalar>& box, vector<int>& userIds) const
+{
+    if (this->root == -1)
+        return;
+
+    // Depth is O(log n) thanks to balancing, so a small fixed stack is enough.
+    int stack[128];
+    int stackSize = 0;
+
+    stack[stackSize++] = this->root;
+
+    while (stackSize > 0)
+    {
+        const Node& node = this->nodes[stack[--stackSize]];
+
+        if (!node.box.overlaps(box))
+            continue;
+
+        if (node.height == 0)
+            userIds.push_back(node.userId);
+        else
+        {
+            stack[stackSize++] = node.child1;
+            stack[stackSize++] = node.child2;
+        }
+    }
+}
+
+template <typename Scalar>
+int AabbTree<Scalar>::allocateNode()
+{
+    int node;
+
+    if (this->firstFreeNode != -1)
+    {
+        node = this->firstFreeNode;
+        this->firstFreeNode = this->nodes[node].parent;
+    }
+    else
+    {
+        node = (int)this->nodes.size();
+        this->nodes.emplace_back();
+    }
+
+    this->nodes[node].parent = -1;
+    this->nodes[node].child1 = -1;
+    this->nodes[node].child2 = -1;
+    this->nodes[node].height = 0;
+    this->nodes[node].userId = -1;
+
+    return node;
+}
+
+template <typename Scalar>
+void AabbTree<Scalar>::freeNode(int node)
+{
+    this->nodes[node].parent = this->firstFreeNode;
+    this->nodes[node].height = -1;
+
+    this->firstFreeNode = node;
+}
+
+template <typename Scalar>
+void AabbTree<Scalar>::insertLeaf(int leaf)
+{
+    if (this->root == -1)
+    {
+        this->root = leaf;
+        this->nodes[leaf].parent = -1;
+        return;
+    }
+
+    Aabb<Scalar> leafBox = this->nodes[leaf].box;
+
+    // Walk down towards the child whose box grows least, stopping where making a new parent here is cheaper.
+    int index = this->root;
+
+    while (this->nodes[index].height > 0)
+    {
+        const Node& node = this->nodes[index];
+
+        Scalar area = node.box.perimeter();
+        Scalar combinedArea = Aabb<Scalar>::merge(node.box, leafBox).perimeter();
+
+        Scalar cost = 2 * combinedArea;
+        Scalar inheritanceCost = 2 * (combinedArea - area);
+
+        Scalar childCosts[2];
+        int children[2] = { node.child1, node.child2 };
+
+        for (int c = 0; c < 2; c++)
+        {
+            const Node& child = this->nodes[children[c]];
+
+            Scalar mergedArea = Aabb<Scalar>::merge(leafBox, child.box).perimeter();
+
+            if (child.height == 0)
+                childCosts[c] = mergedArea + inheritanceCost;
+            else
+                childCosts[c] = mergedArea - child.box.perimeter() + inheritanceCost;
+        }
+
+        if (cost < childCosts[0] && cost < childCosts[1])
+            break;
+
+        index = childCosts[0] < childCosts[1] ? children[0] : children[1];
+    }
+
+    int sibling = index;
+    int oldParent = this->nodes[sibling].parent;
+
+    int newParent = this->allocateNode();
+
+    this->nodes[newParent].parent = oldParent;
+    this->nodes[newParent].box = Aabb<Scalar>::merge(leafBox, this->nodes[sibling].box);
+    this->nodes[newParent].height = this->nodes[sibling].height + 1;
+    this->nodes[newParent].child1 = sibling;
+    this->nodes[newParent].child2 = leaf;
+
+    if (oldParent != -1)
+    {
+        if (this->nodes[oldParent].child1 == sibling)
+            this->nodes[oldParent].child1 = newParent;
+        else
+            this->nodes[oldParent].child2 = newParent;
+    }
+    else
+        this->root = newParent;
+
+    this->nodes[sibling].parent = newParent;
+    this->nodes[leaf].parent = newParent;
+
+    this->refitUpwards(this->nodes[leaf].parent);
+}
+
+template <typename Scalar>
+void AabbTree<Scalar>::removeLeaf(int leaf)
+{
+    if (leaf == this->root)
+    {
+        this->root = -1;
+        return;
+    }
+
+    int parent = this->nodes[leaf].parent;
+    int grandParent = this->nodes[parent].parent;
+    int sibling = this->nodes[parent].child1 == leaf ? this->nodes[parent].child2 : this->nodes[parent].child1;
+
+    if (grandParent != -1)
+    {
+        if (this->nodes[grandParent].child1 == parent)
+            this->nodes[grandParent].child1 = sibling;
+        else
+            this->nodes[grandParent].child2 = sibling;
+
+        this->nodes[sibling].parent = grandParent;
+
+        this->freeNode(parent);
+
+        this->refitUpwards(grandParent);
+    }
+    else
+    {
+        this->root = sibling;
+        this->nodes[sibling].parent = -1;
+
+        this->freeNode(parent);
+    }
+}
+
+template <typename Scalar>
+void AabbTree<Scalar>::refitUpwards(int node)
+{
+    while (node != -1)
+    {
+        node = this->balance(node);
+
+        Node& current = this->nodes[node];
+
+        const Node& child1 = this->nodes[current.child1];
+        const Node& child2 = this->nodes[current.child2];
+
+        current.height = 1 + max(child1.height, child2.height);
+        current.box = Aabb<Scalar>::merge(child1.box, child2.box);
+
+        node = current.parent;
+    }
+}
+
+template <typename Scalar>
+int AabbTree<Scalar>::balance(int iA)
+{
+    Node& A = this->nodes[iA];
+
+    if (A.height < 2)
+        return iA;
+
+    int iB = A.child1;
+    int iC = A.child2;
+
+    Node& B = this->nodes[iB];
+    Node& C = this->nodes[iC];
+
+    int heightDifference = C.height - B.height;
+
+    // Rotate C up.
+    if (heightDifference > 1)
+    {
+        int iF = C.child1;
+        int iG = C.child2;
+
+        Node& F = this->nodes[iF];
+        Node& G = this->nodes[iG];
+
+        C.child1 = iA;
+        C.parent = A.parent;
+        A.parent = iC;
+
+        if (C.parent != -1)
+        {
+            if (this->nodes[C.parent].child1 == iA)
+                this->nodes[C.parent].child1 = iC;
+            else
+                this->nodes[C.parent].child2 = iC;
+        }
+        else
+            this->root = iC;
+
+        if (F.height > G.height)
+        {
+            C.child2 = iF;
+            A.child2 = iG;
+            G.parent = iA;
+
+            A.box = Aabb<Scalar>::merge(B.box, G.box);
+            C.box = Aabb<Scalar>::merge(A.box, F.box);
+
+            A.height = 1 + max(B.height, G.height);
+            C.height = 1 + max(A.height, F.height);
+        }
+        else
+        {
+            C.child2 = iG;
+            A.child2 = iF;
+            F.parent = iA;
+
+            A.box = Aabb<Scalar>::merge(B.box, F.box);
+            C.box = Aabb<Scalar>::merge(A.box, G.box);
+
+            A.height = 1 + max(B.height, F.height);
+            C.height = 1 + max(A.height, G.height);
+        }
+
+        return iC;
+    }
+
+    // Rotate B up.
+    if (heightDifference < -1)
+    {
+        int iD = B.child1;
+        int iE = B.child2;
+
+        Node& D = this->nodes[iD];
+        Node& E = this->nodes[iE];
+
+        B.child1 = iA;
+        B.parent = A.parent;
+        A.parent = iB;
+
+        if (B.parent != -1)
+        {
+            if (this->nodes[B.parent].child1 == iA)
+                this->nodes[B.parent].child1 = iB;
+            else
+                this->nodes[B.parent].child2 = iB;
+        }
+        else
+            this->root = iB;
+
+        if (D.height > E.height)
+        {
+            B.child2 = iD;
+            A.child1 = iE;
+            E.parent = iA;
+
+            A.box = Aabb<Scalar>::merge(C.box, E.box);
+            B.box = Aabb<Scalar>::merge(A.box, D.box);
+
+            A.height = 1 + max(C.height, E.height);
+            B.height = 1 + max(A.height, D.height);
+        }
+        else
+        {
+            B.child2 = iE;
+            A.child1 = iD;
+            D.parent = iA;
+
+            A.box = Aabb<Scalar>::merge(C.box, D.box);
+            B.box = Aabb<Scalar>::merge(A.box, E.box);
+
+            A.height = 1 + max(C.height, D.height);
+            B.height = 1 + max(A.height, E.height);
+        }
+
+        return iB;
+    }
+
+    return iA;
+}
+
+template struct Aabb<float>;
+template struct Aabb<double>;
+
+template struct AabbTree<float>;
+template struct AabbTree<double>;
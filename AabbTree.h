@@ -0,0 +1,76 @@
+#pragma once
+
+#include <vector>
+
+template <typename Scalar>
+struct Aabb
+{
+    Scalar minX;
+    Scalar minY;
+    Scalar maxX;
+    Scalar maxY;
+
+    bool contains(const Aabb& other) const;
+    bool overlaps(const Aabb& other) const;
+
+    Scalar perimeter() const;
+
+    static Aabb merge(const Aabb& first, const Aabb& second);
+};
+
+// Dynamic bounding volume tree. Leaves store fattened boxes, so a body that moves a little stays inside its leaf and
+// costs nothing; only a body that leaves its fat box is removed and reinserted. Inserts pick the sibling by perimeter
+// cost and rotations keep the tree balanced, so a query touches O(log n) nodes plus its hits.
+template <typename Scalar>
+struct AabbTree
+{
+    struct Node
+    {
+        Aabb<Scalar> box;
+
+        // Parent while in the tree, next free node while on the free list.
+        int parent;
+
+        int child1;
+        int child2;
+
+        // Leaves have height 0 and no children.
+        int height;
+
+        int userId;
+    };
+
+    std::vector<Node> nodes;
+
+    int root = -1;
+    int firstFreeNode = -1;
+
+    // The owner's bodiesVersion when the leaves were last created; any other value means they name the wrong bodies.
+    int bodiesVersion = -1;
+
+    int reinsertions = 0;
+
+    void clear();
+
+    // Inserts a leaf holding box grown by margin on every side; the returned proxy id stays valid until destroyProxy.
+    int createProxy(const Aabb<Scalar>& box, Scalar margin, int userId);
+    void destroyProxy(int proxy);
+
+    // Reinserts the proxy with a new fat box if box has left the old one; returns whether it did.
+    bool moveProxy(int proxy, const Aabb<Scalar>& box, Scalar margin);
+
+    // Appends the userId of every leaf whose fat box overlaps box, in no particular order.
+    void query(const Aabb<Scalar>& box, std::vector<int>& userIds) const;
+
+    int allocateNode();
+    void freeNode(int node);
+
+    void insertLeaf(int leaf);
+    void removeLeaf(int leaf);
+
+    // Rotates the subtree at node if its children's heights differ by more than one; returns the subtree's new root.
+    int balance(int node);
+
+    // Recomputes heights and boxes from node up to the root, balancing on the way.
+    void refitUpwards(int node);
+};
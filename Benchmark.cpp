@@ -0,0 +1,469 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <functional>
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "World.h"
+#include "SimdKernels.h"
+#include "Geometry.h"
+
+using namespace std;
+
+struct BenchmarkOptions
+{
+    vector<int> circleCounts = { 50, 100, 1000, 10000, 100000, 1000000 };
+    int numCapsules = 1;
+
+    int calls = 16;
+    double maxPairTests = 5e9;
+
+    bool constantDensity = true;
+
+    bool reorder = false;
+
+    // Threads of the colored contact pass; 0 keeps the world's default, one per hardware thread.
+    int contactThreads = 0;
+
+    double minRadius = SPAWN_MIN_RADIUS;
+    double maxRadius = SPAWN_MAX_RADIUS;
+
+    string format = "csv";
+    string outputPath;
+
+    unsigned int seed = 0;
+
+    bool runFloat = false;
+    bool runDouble = true;
+};
+
+struct BenchmarkResult
+{
+    string kernel;
+    string scalar;
+
+    int circles;
+    int capsules;
+
+    int calls;
+
+    double pairs;
+
+    double nsPerCall;
+    double nsPerBody;
+    double nsPerPair;
+
+    bool skipped;
+};
+
+void printUsage(const char* programName)
+{
+    cout << "Usage: " << programName << " [options]\n"
+        << "  --sizes N,N,...        circle counts to sweep (default 50,100,1000,10000,100000,1000000)\n"
+        << "  --capsules N           number of capsules (default 1)\n"
+        << "  --calls N              timed calls per kernel (default 16)\n"
+        << "  --max-pair-tests N     budget of circle-circle pair tests per size (default 5e9)\n"
+        << "  --fixed-area           keep the window-sized box instead of growing it with the body count\n"
+        << "  --radius MIN,MAX       radius range of spawned circles (default " << SPAWN_MIN_RADIUS << "," << SPAWN_MAX_RADIUS << ")\n"
+        << "  --reorder              sort the circles along a Morton curve before timing the kernels\n"
+        << "  --threads N            threads of the colored contact pass (default: one per hardware thread)\n"
+        << "  --format csv|json      output format (default csv)\n"
+        << "  --output FILE          write results to FILE instead of stdout\n"
+        << "  --seed N               scene seed (default 0)\n"
+        << "  --scalar float|double|both  precision of the benchmarked world (default double)\n";
+}
+
+bool parseSizes(const char* value, vector<int>& circleCounts)
+{
+    circleCounts.clear();
+
+    stringstream stream(value);
+    string item;
+
+    while (getline(stream, item, ','))
+    {
+        int count = atoi(item.c_str());
+
+        if (count <= 0)
+            return false;
+
+        circleCounts.push_back(count);
+    }
+
+    return !circleCounts.empty();
+}
+
+bool parseOptions(int argc, char** argv, BenchmarkOptions& options)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--help") == 0)
+            return false;
+
+        if (strcmp(argv[i], "--fixed-area") == 0)
+        {
+            options.constantDensity = false;
+            continue;
+        }
+
+        if (strcmp(argv[i], "--reorder") == 0)
+        {
+            options.reorder = true;
+            continue;
+        }
+
+        if (i + 1 >= argc)
+        {
+            cerr << "Missing value for " << argv[i] << "\n";
+            return false;
+        }
+
+        const char* value = argv[++i];
+
+        if (strcmp(argv[i - 1], "--radius") == 0)
+        {
+            if (sscanf(value, "%lf,%lf", &options.minRadius, &options.maxRadius) != 2 || options.minRadius <= 0.0 || options.maxRadius < options.minRadius)
+            {
+                cerr << "Invalid radius range " << value << "\n";
+                return false;
+            }
+        }
+        else if (strcmp(argv[i - 1], "--sizes") == 0)
+        {
+            if (!parseSizes(value, options.circleCounts))
+            {
+                cerr << "Invalid sizes " << value << "\n";
+                return false;
+            }
+        }
+        else if (strcmp(argv[i - 1], "--capsules") == 0)
+            options.numCapsules = atoi(value);
+        else if (strcmp(argv[i - 1], "--calls") == 0)
+            options.calls = atoi(value);
+        else if (strcmp(argv[i - 1], "--threads") == 0)
+            options.contactThreads = atoi(value);
+        else if (strcmp(argv[i - 1], "--max-pair-tests") == 0)
+            options.maxPairTests = atof(value);
+        else if (strcmp(argv[i - 1], "--format") == 0)
+            options.format = value;
+        else if (strcmp(argv[i - 1], "--output") == 0)
+            options.outputPath = value;
+        else if (strcmp(argv[i - 1], "--seed") == 0)
+            options.seed = (unsigned int)strtoul(value, nullptr, 10);
+        else if (strcmp(argv[i - 1], "--scalar") == 0)
+        {
+            options.runFloat = strcmp(value, "float") == 0 || strcmp(value, "both") == 0;
+            options.runDouble = strcmp(value, "double") == 0 || strcmp(value, "both") == 0;
+
+            if (!options.runFloat && !options.runDouble)
+            {
+                cerr << "Invalid scalar " << value << "\n";
+                return false;
+            }
+        }
+        else
+        {
+            cerr << "Unknown option " << argv[i - 1] << "\n";
+            return false;
+        }
+    }
+
+    if (options.numCapsules < 0 || options.calls <= 0 || options.contactThreads < 0 || (options.format != "csv" && options.format != "json"))
+    {
+        cerr << "Invalid option value\n";
+        return false;
+    }
+
+    return true;
+}
+
+double timeCalls(int calls, const function<void()>& kernel)
+{
+    auto startTime = chrono::steady_clock::now();
+
+    for (int call = 0; call < calls; call++)
+        kernel();
+
+    auto endTime = chrono::steady_clock::now();
+
+    return chrono::duration<double, nano>(endTime - startTime).count() / calls;
+}
+
+template <typename Scalar>
+BenchmarkResult makeResult(const string& kernel, int circles, int capsules, int calls, double nsPerCall, double bodies, double pairs)
+{
+    BenchmarkResult result;
+
+    result.kernel = kernel;
+    result.scalar = sizeof(Scalar) == sizeof(float) ? "float" : "double";
+    result.circles = circles;
+    result.capsules = capsules;
+    result.calls = calls;
+    result.pairs = pairs;
+    result.nsPerCall = nsPerCall;
+    result.nsPerBody = bodies > 0.0 ? nsPerCall / bodies : 0.0;
+    result.nsPerPair = pairs > 0.0 ? nsPerCall / pairs : 0.0;
+    result.skipped = false;
+
+    return result;
+}
+
+template <typename Scalar>
+void createBenchmarkScene(BasicWorld<Scalar>& world, const BenchmarkOptions& options, int numCircles)
+{
+    if (options.constantDensity)
+    {
+        // Keep the default scene's 50 circles per window area so contact counts stay comparable across sizes.
+        double scale = sqrt(numCircles / 50.0);
+
+        if (scale > 1.0)
+        {
+            world.width = Scalar(WINDOW_WIDTH * scale);
+            world.height = Scalar(WINDOW_HEIGHT * scale);
+        }
+    }
+
+    createDefaultScene(world, numCircles, options.numCapsules, options.seed, options.minRadius, options.maxRadius);
+
+    if (options.reorder)
+        world.reorderCircles();
+
+    world.simulationDeltaTime = Scalar(1.0 / 60.0 / world.numberOfSimulations);
+
+    if (options.contactThreads > 0)
+        world.contactThreads = options.contactThreads;
+}
+
+// Times calls of kernel on a scene built afresh from the seed, so no kernel measures a world an earlier one has
+// already stepped.
+template <typename Scalar>
+double timeKernel(const BenchmarkOptions& options, int numCircles, int calls, const function<void(BasicWorld<Scalar>&)>& kernel)
+{
+    BasicWorld<Scalar> world;
+
+    createBenchmarkScene(world, options, numCircles);
+
+    return timeCalls(calls, [&]() { kernel(world); });
+}
+
+template <typename Scalar>
+void benchmarkSize(const BenchmarkOptions& options, int numCircles, vector<BenchmarkResult>& results)
+{
+    int numCapsules = options.numCapsules;
+
+    double circlePairs = 0.5 * numCircles * (numCircles - 1.0);
+    double capsulePairs = 1.0 * numCircles * numCapsules;
+
+    double nsPerCall = timeKernel<Scalar>(options, numCircles, options.calls, [&](BasicWorld<Scalar>& world) { world.handleWallCollisions(); });
+    results.push_back(makeResult<Scalar>("wall", numCircles, numCapsules, options.calls, nsPerCall, numCircles, 0.0));
+
+    int circleCalls = options.calls;
+
+    if (circlePairs * circleCalls > options.maxPairTests)
+        circleCalls = (int)(options.maxPairTests / max(circlePairs, 1.0));
+
+    if (circleCalls >= 1)
+    {
+        nsPerCall = timeKernel<Scalar>(options, numCircles, circleCalls, [&](BasicWorld<Scalar>& world) { world.handleCircleCollisionsAllPairs(); });
+        results.push_back(makeResult<Scalar>("circle-circle", numCircles, numCapsules, circleCalls, nsPerCall, numCircles, circlePairs));
+    }
+    else
+    {
+        BenchmarkResult result = makeResult<Scalar>("circle-circle", numCircles, numCapsules, 0, 0.0, 0.0, 0.0);
+        result.skipped = true;
+        results.push_back(result);
+    }
+
+    nsPerCall = timeKernel<Scalar>(options, numCircles, options.calls, [&](BasicWorld<Scalar>& world) { world.handleCircleCollisionsGrid(); });
+    results.push_back(makeResult<Scalar>("circle-circle-grid", numCircles, numCapsules, options.calls, nsPerCall, numCircles, 0.0));
+
+    // Whichever of the two above CIRCLE_BROADPHASE_AUTO picks for this size.
+    nsPerCall = timeKernel<Scalar>(options, numCircles, options.calls, [&](BasicWorld<Scalar>& world) { world.handleCircleCollisions(); });
+    results.push_back(makeResult<Scalar>("circle-circle-auto", numCircles, numCapsules, options.calls, nsPerCall, numCircles, 0.0));
+
+    nsPerCall = timeKernel<Scalar>(options, numCircles, options.calls, [&](BasicWorld<Scalar>& world) { world.handleCircleCollisionsSweep(); });
+    results.push_back(makeResult<Scalar>("circle-circle-sweep", numCircles, numCapsules, options.calls, nsPerCall, numCircles, 0.0));
+
+    nsPerCall = timeKernel<Scalar>(options, numCircles, options.calls, [&](BasicWorld<Scalar>& world) { world.handleCircleCollisionsTree(); });
+    results.push_back(makeResult<Scalar>("circle-circle-tree", numCircles, numCapsules, options.calls, nsPerCall, numCircles, 0.0));
+
+    nsPerCall = timeKernel<Scalar>(options, numCircles, options.calls, [&](BasicWorld<Scalar>& world) { world.handleCircleCollisionsHierarchicalGrid(); });
+    results.push_back(makeResult<Scalar>("circle-circle-hgrid", numCircles, numCapsules, options.calls, nsPerCall, numCircles, 0.0));
+
+    nsPerCall = timeKernel<Scalar>(options, numCircles, options.calls, [&](BasicWorld<Scalar>& world) { world.handleCircleCollisionsVerlet(); });
+    results.push_back(makeResult<Scalar>("circle-circle-verlet", numCircles, numCapsules, options.calls, nsPerCall, numCircles, 0.0));
+
+    nsPerCall = timeKernel<Scalar>(options, numCircles, options.calls, [&](BasicWorld<Scalar>& world) { world.handleCircleCollisionsColored(); });
+    results.push_back(makeResult<Scalar>("circle-circle-colored", numCircles, numCapsules, options.calls, nsPerCall, numCircles, 0.0));
+
+    nsPerCall = timeKernel<Scalar>(options, numCircles, options.calls, [&](BasicWorld<Scalar>& world) { world.handleCircleCollisionsIslands(); });
+    results.push_back(makeResult<Scalar>("circle-circle-islands", numCircles, numCapsules, options.calls, nsPerCall, numCircles, 0.0));
+
+    nsPerCall = timeKernel<Scalar>(options, numCircles, options.calls, [&](BasicWorld<Scalar>& world) { world.handleCapsuleCollisionsAllPairs(); });
+    results.push_back(makeResult<Scalar>("circle-capsule", numCircles, numCapsules, options.calls, nsPerCall, numCircles, capsulePairs));
+
+    nsPerCall = timeKernel<Scalar>(options, numCircles, options.calls, [&](BasicWorld<Scalar>& world) { world.handleCapsuleCollisionsSweep(); });
+    results.push_back(makeResult<Scalar>("circle-capsule-sweep", numCircles, numCapsules, options.calls, nsPerCall, numCircles, 0.0));
+
+    nsPerCall = timeKernel<Scalar>(options, numCircles, options.calls, [&](BasicWorld<Scalar>& world) { world.handleCapsuleCollisionsTree(); });
+    results.push_back(makeResult<Scalar>("circle-capsule-tree", numCircles, numCapsules, options.calls, nsPerCall, numCircles, 0.0));
+
+    nsPerCall = timeKernel<Scalar>(options, numCircles, options.calls, [&](BasicWorld<Scalar>& world) { world.updateCirclesStatuses(); });
+    results.push_back(makeResult<Scalar>("update", numCircles, numCapsules, options.calls, nsPerCall, numCircles, 0.0));
+
+    // The first call sorts a scrambled scene (unless --reorder already did); the rest measure the nearly sorted case.
+    nsPerCall = timeKernel<Scalar>(options, numCircles, options.calls, [&](BasicWorld<Scalar>& world) { world.reorderCircles(); });
+    results.push_back(makeResult<Scalar>("reorder", numCircles, numCapsules, options.calls, nsPerCall, numCircles, 0.0));
+
+    // Despawn and respawn up to 1000 random circles per call through the handle registry.
+    int churnCount = min(numCircles / 2, 1000);
+
+    vector<BodyHandle> despawned;
+    vector<BasicCircle<Scalar>> spawned;
+
+    if (churnCount > 0)
+    {
+        nsPerCall = timeKernel<Scalar>(options, numCircles, options.calls, [&](BasicWorld<Scalar>& world) {
+            despawned.clear();
+            spawned.clear();
+
+            for (int k = 0; k < churnCount; k++)
+                despawned.push_back(world.circleRegistry.handleAt(rand() % world.circles.size()));
+
+            int removed = world.removeCircles(despawned);
+
+            for (int k = 0; k < removed; k++)
+                spawned.push_back(createRandomCircle(world, options.minRadius, options.maxRadius));
+
+            world.addCircles(spawned);
+        });
+        results.push_back(makeResult<Scalar>("spawn-despawn", numCircles, numCapsules, options.calls, nsPerCall, churnCount, 0.0));
+    }
+
+    vector<Scalar> drawnPoints;
+
+    nsPerCall = timeKernel<Scalar>(options, numCircles, options.calls, [&](BasicWorld<Scalar>& world) {
+        for (int i = 0; i < world.circles.size(); i++)
+        {
+            drawnPoints.clear();
+            generateCirclePoints(world.circles.posX[i], world.circles.posY[i], world.circles.radius[i], drawnPoints);
+        }
+    });
+    results.push_back(makeResult<Scalar>("circle-vertices", numCircles, numCapsules, options.calls, nsPerCall, numCircles, 0.0));
+
+    nsPerCall = timeKernel<Scalar>(options, numCircles, options.calls, [&](BasicWorld<Scalar>& world) {
+        for (int j = 0; j < world.capsules.size(); j++)
+        {
+            drawnPoints.clear();
+            generateCapsulePoints(world.capsules[j], drawnPoints);
+        }
+    });
+    results.push_back(makeResult<Scalar>("capsule-vertices", numCircles, numCapsules, options.calls, nsPerCall, numCapsules, 0.0));
+}
+
+void writeCsv(ostream& output, const vector<BenchmarkResult>& results)
+{
+    output << "kernel,scalar,circles,capsules,calls,ns_per_call,ns_per_body,ns_per_pair\n";
+
+    for (int i = 0; i < results.size(); i++)
+    {
+        const BenchmarkResult& result = results[i];
+
+        output << result.kernel << "," << result.scalar << "," << result.circles << "," << result.capsules << "," << result.calls << ",";
+
+        if (result.skipped)
+            output << ",,\n";
+        else
+        {
+            output << result.nsPerCall << "," << result.nsPerBody << ",";
+
+            if (result.pairs > 0.0)
+                output << result.nsPerPair;
+
+            output << "\n";
+        }
+    }
+}
+
+void writeJson(ostream& output, const vector<BenchmarkResult>& results)
+{
+    output << "[\n";
+
+    for (int i = 0; i < results.size(); i++)
+    {
+        const BenchmarkResult& result = results[i];
+
+        output << "  { \"kernel\": \"" << result.kernel << "\", \"scalar\": \"" << result.scalar << "\", \"circles\": " << result.circles << ", \"capsules\": " << result.capsules << ", \"calls\": " << result.calls;
+
+        if (result.skipped)
+            output << ", \"skipped\": true }";
+        else
+        {
+            output << ", \"ns_per_call\": " << result.nsPerCall << ", \"ns_per_body\": " << result.nsPerBody << ", \"ns_per_pair\": ";
+
+            if (result.pairs > 0.0)
+                output << result.nsPerPair;
+            else
+                output << "null";
+
+            output << " }";
+        }
+
+        output << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+
+    output << "]\n";
+}
+
+int main(int argc, char** argv)
+{
+    BenchmarkOptions options;
+
+    if (!parseOptions(argc, argv, options))
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    vector<BenchmarkResult> results;
+
+    for (int i = 0; i < options.circleCounts.size(); i++)
+    {
+        cerr << "benchmarking " << options.circleCounts[i] << " circles (simd: " << simdInstructionSet() << ")\n";
+
+        if (options.runDouble)
+            benchmarkSize<double>(options, options.circleCounts[i], results);
+
+        if (options.runFloat)
+            benchmarkSize<float>(options, options.circleCounts[i], results);
+    }
+
+    ofstream file;
+
+    if (!options.outputPath.empty())
+    {
+        file.open(options.outputPath);
+
+        if (!file)
+        {
+            cerr << "Could not open " << options.outputPath << "\n";
+            return 1;
+        }
+    }
+
+    ostream& output = options.outputPath.empty() ? cout : file;
+
+    if (options.format == "json")
+        writeJson(output, results);
+    else
+        writeCsv(output, results);
+
+    return 0;
+}
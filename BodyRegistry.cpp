@@ -0,0 +1,126 @@
+#include "BodyRegistry.h"
+
+using namespace std;
+
+int BodyRegistry::size() const
+{
+    return (int)this->denseToSlot.size();
+}
+
+void BodyRegistry::reserve(int capacity)
+{
+    this->slots.reserve(capacity);
+    this->denseToSlot.reserve(capacity);
+}
+
+BodyHandle BodyRegistry::create()
+{
+    int slotIndex;
+
+    if (this->firstFreeSlot != -1)
+    {
+        slotIndex = this->firstFreeSlot;
+        this->firstFreeSlot = this->slots[slotIndex].nextFreeSlot;
+    }
+    else
+    {
+        Slot slot;
+
+        slot.generation = 0;
+
+        this->slots.push_back(slot);
+        slotIndex = (int)this->slots.size() - 1;
+    }
+
+    Slot& slot = this->slots[slotIndex];
+
+    slot.denseIndex = (int)this->denseToSlot.size();
+    slot.nextFreeSlot = -1;
+
+    this->denseToSlot.push_back(slotIndex);
+
+    BodyHandle handle;
+
+    handle.slot = slotIndex;
+    handle.generation = slot.generation;
+
+    return handle;
+}
+
+bool BodyRegistry::isValid(BodyHandle handle) const
+{
+    return this->denseIndex(handle) != -1;
+}
+
+int BodyRegistry::denseIndex(BodyHandle handle) const
+{
+    if (handle.slot >= this->slots.size())
+        return -1;
+
+    const Slot& slot = this->slots[handle.slot];
+
+    if (slot.generation != handle.generation || slot.denseIndex == -1)
+        return -1;
+
+    return slot.denseIndex;
+}
+
+BodyHandle BodyRegistry::handleAt(int denseIndex) const
+{
+    BodyHandle handle;
+
+    handle.slot = this->denseToSlot[denseIndex];
+    handle.generation = this->slots[handle.slot].generation;
+
+    return handle;
+}
+
+int BodyRegistry::remove(BodyHandle handle)
+{
+    int removedIndex = this->denseIndex(handle);
+
+    if (removedIndex == -1)
+        return -1;
+
+    int lastIndex = (int)this->denseToSlot.size() - 1;
+
+    uint32_t movedSlot = this->denseToSlot[lastIndex];
+
+    this->denseToSlot[removedIndex] = movedSlot;
+    this->slots[movedSlot].denseIndex = removedIndex;
+
+    this->denseToSlot.pop_back();
+
+    Slot& slot = this->slots[handle.slot];
+
+    slot.generation++;
+    slot.denseIndex = -1;
+    slot.nextFreeSlot = this->firstFreeSlot;
+
+    this->firstFreeSlot = handle.slot;
+
+    return removedIndex;
+}
+
+void BodyRegistry::permute(const vector<int>& order)
+{
+    vector<uint32_t> oldDenseToSlot = this->denseToSlot;
+
+    for (int n = 0; n < order.size(); n++)
+    {
+        this->denseToSlot[n] = oldDenseToSlot[order[n]];
+        this->slots[this->denseToSlot[n]].denseIndex = n;
+    }
+}
+
+void BodyRegistry::swap(int a, int b)
+{
+    uint32_t slotA = this->denseToSlot[a];
+    uint32_t slotB = this->denseToSlot[b];
+
+    this->denseToSlot[a] = slotB;
+    this->denseToSlot[b] = slotA;
+
+    this->slots[slotA].denseIndex = b;
+    this->slots[slotB].denseIndex = a;
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// Stable reference to a body. The slot index never changes while the body lives; the generation is bumped every
+// time the slot is reused, so handles to despawned bodies are detected instead of aliasing a newer body.
+struct BodyHandle
+{
+    uint32_t slot = 0xFFFFFFFFu;
+    uint32_t generation = 0;
+
+    bool operator==(const BodyHandle& other) const
+    {
+        return this->slot == other.slot && this->generation == other.generation;
+    }
+
+    bool operator!=(const BodyHandle& other) const
+    {
+        return !(*this == other);
+    }
+};
+
+const BodyHandle INVALID_BODY_HANDLE = BodyHandle();
+
+// Maps handles to positions in a dense array (and back). Freed slots go on a free list and are reused, so spawning
+// never grows the slot table once it has reached the peak body count.
+struct BodyRegistry
+{
+    struct Slot
+    {
+        uint32_t generation;
+
+        // Position in the dense arrays while alive, next free slot while on the free list.
+        int denseIndex;
+        int nextFreeSlot;
+    };
+
+    std::vector<Slot> slots;
+    std::vector<uint32_t> denseToSlot;
+
+    int firstFreeSlot = -1;
+
+    int size() const;
+
+    void reserve(int capacity);
+
+    // Registers the body just appended at the end of the dense arrays.
+    BodyHandle create();
+
+    bool isValid(BodyHandle handle) const;
+
+    // Dense index of a live body, or -1 for a stale or invalid handle.
+    int denseIndex(BodyHandle handle) const;
+
+    BodyHandle handleAt(int denseIndex) const;
+
+    // Frees the handle's slot. The caller swap-removes the dense arrays: the last element moves into the returned
+    // index (the registry has already been updated for it) and the arrays shrink by one. Returns -1 for stale handles.
+    int remove(BodyHandle handle);
+
+    // The caller reorders the dense arrays so that new index n holds what was at order[n]; handles keep pointing at
+    // the same bodies.
+    void permute(const std::vector<int>& order);
+
+    // The caller swaps dense elements a and b; handles keep pointing at the same bodies.
+    void swap(int a, int b);
+};
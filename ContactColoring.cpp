@@ -0,0 +1,85 @@
+#include "ContactColoring.h"
+
+#include <algorithm>
+
+using namespace std;
+
+void ContactColoring::clear()
+{
+    this->pairA.clear();
+    this->pairB.clear();
+}
+
+void ContactColoring::addPair(int a, int b)
+{
+    this->pairA.push_back(a);
+    this->pairB.push_back(b);
+}
+
+void ContactColoring::color(int numDynamicBodies)
+{
+    int numPairs = (int)this->pairA.size();
+
+    this->bodyColors.assign(numDynamicBodies, 0);
+    this->pairColor.resize(numPairs);
+
+    this->numBatches = 0;
+    this->overflowBatch = false;
+
+    for (int p = 0; p < numPairs; p++)
+    {
+        int a = this->pairA[p];
+        int b = this->pairB[p];
+
+        unsigned long long used = this->bodyColors[a];
+
+        if (b < numDynamicBodies)
+            used |= this->bodyColors[b];
+
+        int color = 0;
+
+        while (color < MAX_CONTACT_COLORS && (used >> color & 1))
+            color++;
+
+        this->pairColor[p] = color;
+
+        if (color == MAX_CONTACT_COLORS)
+        {
+            this->overflowBatch = true;
+        }
+        else
+        {
+            this->bodyColors[a] |= 1ull << color;
+
+            if (b < numDynamicBodies)
+                this->bodyColors[b] |= 1ull << color;
+        }
+
+        this->numBatches = max(this->numBatches, color + 1);
+    }
+
+    // Group by color with a stable counting sort.
+    this->batchStart.assign(this->numBatches + 1, 0);
+
+    for (int p = 0; p < numPairs; p++)
+        this->batchStart[this->pairColor[p] + 1]++;
+
+    for (int c = 0; c < this->numBatches; c++)
+        this->batchStart[c + 1] += this->batchStart[c];
+
+    this->batchA.resize(numPairs);
+    this->batchB.resize(numPairs);
+
+    for (int p = 0; p < numPairs; p++)
+    {
+        int entry = this->batchStart[this->pairColor[p]]++;
+
+        this->batchA[entry] = this->pairA[p];
+        this->batchB[entry] = this->pairB[p];
+    }
+
+    for (int c = this->numBatches; c > 0; c--)
+        this->batchStart[c] = this->batchStart[c - 1];
+
+    this->batchStart[0] = 0;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <vector>
+
+// Contacts needing more colors than a body's bit mask holds go to one extra batch, which is resolved on one thread.
+const int MAX_CONTACT_COLORS = 64;
+
+// Greedy coloring of contact pairs into batches in which no dynamic body appears twice, so the pairs of one batch can
+// be resolved in parallel without two threads writing the same body. Pairs are colored in the order they were added,
+// each taking the lowest color neither of its bodies has yet, so the batches only depend on that order.
+struct ContactColoring
+{
+    // Pairs as added.
+    std::vector<int> pairA;
+    std::vector<int> pairB;
+
+    // Bit c of bodyColors[i] is set once a pair of body i took color c.
+    std::vector<unsigned long long> bodyColors;
+    std::vector<int> pairColor;
+
+    // Batch c holds batchA[batchStart[c]] .. batchA[batchStart[c + 1] - 1] (and the same range of batchB), in the
+    // order the pairs were added. When overflowBatch is set, the last batch is the overflow one and may repeat bodies.
+    std::vector<int> batchStart;
+    std::vector<int> batchA;
+    std::vector<int> batchB;
+
+    int numBatches = 0;
+    bool overflowBatch = false;
+
+    void clear();
+
+    void addPair(int a, int b);
+
+    // Bodies numDynamicBodies and above are static: their pairs read them but never write them, so they do not
+    // constrain the colors.
+    void color(int numDynamicBodies);
+};
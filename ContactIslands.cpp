@@ -0,0 +1,107 @@
+#include "ContactIslands.h"
+
+#include <algorithm>
+
+using namespace std;
+
+void ContactIslands::clear()
+{
+    this->pairA.clear();
+    this->pairB.clear();
+}
+
+void ContactIslands::addPair(int a, int b)
+{
+    this->pairA.push_back(a);
+    this->pairB.push_back(b);
+}
+
+void ContactIslands::build(int numDynamicBodies)
+{
+    int numPairs = (int)this->pairA.size();
+
+    this->bodySets.reset(numDynamicBodies);
+
+    for (int p = 0; p < numPairs; p++)
+    {
+        if (this->pairB[p] < numDynamicBodies)
+            this->bodySets.unite(this->pairA[p], this->pairB[p]);
+    }
+
+    // Number the islands in the order their first pair was added.
+    this->rootIsland.assign(numDynamicBodies, -1);
+    this->pairIsland.resize(numPairs);
+
+    this->islandPairs.clear();
+    this->islandBodies.clear();
+
+    for (int p = 0; p < numPairs; p++)
+    {
+        int root = this->bodySets.find(this->pairA[p]);
+
+        if (this->rootIsland[root] < 0)
+        {
+            this->rootIsland[root] = (int)this->islandPairs.size();
+            this->islandPairs.push_back(0);
+            this->islandBodies.push_back(this->bodySets.setSize[root]);
+        }
+
+        this->pairIsland[p] = this->rootIsland[root];
+        this->islandPairs[this->pairIsland[p]]++;
+    }
+
+    this->numIslands = (int)this->islandPairs.size();
+
+    // Largest first for load balance, single-body islands last.
+    this->islandOrder.resize(this->numIslands);
+
+    for (int k = 0; k < this->numIslands; k++)
+        this->islandOrder[k] = k;
+
+    stable_sort(this->islandOrder.begin(), this->islandOrder.end(), [this](int a, int b)
+    {
+        bool singleA = this->islandBodies[a] == 1;
+        bool singleB = this->islandBodies[b] == 1;
+
+        if (singleA != singleB)
+            return singleB;
+
+        return this->islandPairs[a] > this->islandPairs[b];
+    });
+
+    this->islandRank.resize(this->numIslands);
+    this->numSingleBodyIslands = 0;
+
+    for (int r = 0; r < this->numIslands; r++)
+    {
+        this->islandRank[this->islandOrder[r]] = r;
+
+        if (this->islandBodies[this->islandOrder[r]] == 1)
+            this->numSingleBodyIslands++;
+    }
+
+    // Group the pairs by rank with a stable counting sort.
+    this->islandStart.assign(this->numIslands + 1, 0);
+
+    for (int p = 0; p < numPairs; p++)
+        this->islandStart[this->islandRank[this->pairIsland[p]] + 1]++;
+
+    for (int r = 0; r < this->numIslands; r++)
+        this->islandStart[r + 1] += this->islandStart[r];
+
+    this->islandA.resize(numPairs);
+    this->islandB.resize(numPairs);
+
+    for (int p = 0; p < numPairs; p++)
+    {
+        int entry = this->islandStart[this->islandRank[this->pairIsland[p]]]++;
+
+        this->islandA[entry] = this->pairA[p];
+        this->islandB[entry] = this->pairB[p];
+    }
+
+    for (int r = this->numIslands; r > 0; r--)
+        this->islandStart[r] = this->islandStart[r - 1];
+
+    this->islandStart[0] = 0;
+}
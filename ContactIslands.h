@@ -0,0 +1,45 @@
+#pragma once
+
+#include <vector>
+
+#include "UnionFind.h"
+
+// Connected components of the contact graph. Only dynamic bodies join islands: a static body (a capsule or a sleeping
+// circle) is read by its contacts but never written, so the bodies touching it can still be solved apart. Each
+// island's pairs keep the order they were added in, so solving an island alone does the same work as the whole pass
+// restricted to it.
+struct ContactIslands
+{
+    // Pairs as added.
+    std::vector<int> pairA;
+    std::vector<int> pairB;
+
+    UnionFind bodySets;
+
+    // Island of every set representative, and of every pair.
+    std::vector<int> rootIsland;
+    std::vector<int> pairIsland;
+
+    // Island k holds islandA[islandStart[k]] .. islandA[islandStart[k + 1] - 1] (and the same range of islandB),
+    // islands ordered by decreasing pair count. The last numSingleBodyIslands islands have one dynamic body, whose
+    // pairs are all against static bodies.
+    std::vector<int> islandStart;
+    std::vector<int> islandA;
+    std::vector<int> islandB;
+
+    int numIslands = 0;
+    int numSingleBodyIslands = 0;
+
+    // Scratch space for ordering the islands.
+    std::vector<int> islandPairs;
+    std::vector<int> islandBodies;
+    std::vector<int> islandOrder;
+    std::vector<int> islandRank;
+
+    void clear();
+
+    void addPair(int a, int b);
+
+    // Bodies numDynamicBodies and above are static. Bodies without pairs are in no island.
+    void build(int numDynamicBodies);
+};
@@ -0,0 +1,84 @@
+#include "Geometry.h"
+
+#include <cmath>
+
+using namespace std;
+
+template <typename Scalar>
+void generateCirclePoints(Scalar posX, Scalar posY, Scalar radius, vector<Scalar>& drawnPoints)
+{
+    double currentAngle = 0.0;
+
+    while (currentAngle < 2.0 * PI)
+    {
+        drawnPoints.emplace_back(Scalar(posX + radius * cos(currentAngle)));
+        drawnPoints.emplace_back(Scalar(posY + radius * sin(currentAngle)));
+
+        drawnPoints.emplace_back(posX);
+        drawnPoints.emplace_back(posY);
+
+        drawnPoints.emplace_back(Scalar(posX + radius * cos(currentAngle + DRAW_ANGLE_STEP)));
+        drawnPoints.emplace_back(Scalar(posY + radius * sin(currentAngle + DRAW_ANGLE_STEP)));
+
+        currentAngle += DRAW_ANGLE_STEP;
+    }
+}
+
+template <typename Scalar>
+void generateCapsulePoints(const BasicCapsule<Scalar>& capsule, vector<Scalar>& drawnPoints)
+{
+    for (int k = 0; k < 2; k++)
+    {
+        double currentAngle = 0.0;
+
+        while (currentAngle < 2.0 * PI)
+        {
+            drawnPoints.emplace_back(Scalar(capsule.posX[k] + capsule.radius * cos(currentAngle)));
+            drawnPoints.emplace_back(Scalar(capsule.posY[k] + capsule.radius * sin(currentAngle)));
+
+            drawnPoints.emplace_back(capsule.posX[k]);
+            drawnPoints.emplace_back(capsule.posY[k]);
+
+            drawnPoints.emplace_back(Scalar(capsule.posX[k] + capsule.radius * cos(currentAngle + DRAW_ANGLE_STEP)));
+            drawnPoints.emplace_back(Scalar(capsule.posY[k] + capsule.radius * sin(currentAngle + DRAW_ANGLE_STEP)));
+
+            currentAngle += DRAW_ANGLE_STEP;
+        }
+    }
+
+    Scalar deltaX = capsule.posX[0] - capsule.posX[1];
+    Scalar deltaY = capsule.posY[0] - capsule.posY[1];
+
+    Scalar centersDist = sqrt(deltaX * deltaX + deltaY * deltaY);
+
+    deltaX = deltaX / centersDist * capsule.radius;
+    deltaY = deltaY / centersDist * capsule.radius;
+
+    Scalar aux = deltaX;
+    deltaX = deltaY;
+    deltaY = -aux;
+
+    drawnPoints.emplace_back(capsule.posX[0] + deltaX);
+    drawnPoints.emplace_back(capsule.posY[0] + deltaY);
+
+    drawnPoints.emplace_back(capsule.posX[1] + deltaX);
+    drawnPoints.emplace_back(capsule.posY[1] + deltaY);
+
+    drawnPoints.emplace_back(capsule.posX[1] - deltaX);
+    drawnPoints.emplace_back(capsule.posY[1] - deltaY);
+
+    drawnPoints.emplace_back(capsule.posX[1] - deltaX);
+    drawnPoints.emplace_back(capsule.posY[1] - deltaY);
+
+    drawnPoints.emplace_back(capsule.posX[0] - deltaX);
+    drawnPoints.emplace_back(capsule.posY[0] - deltaY);
+
+    drawnPoints.emplace_back(capsule.posX[0] + deltaX);
+    drawnPoints.emplace_back(capsule.posY[0] + deltaY);
+}
+
+template void generateCirclePoints(float posX, float posY, float radius, vector<float>& drawnPoints);
+template void generateCirclePoints(double posX, double posY, double radius, vector<double>& drawnPoints);
+
+template void generateCapsulePoints(const BasicCapsule<float>& capsule, vector<float>& drawnPoints);
+template void generateCapsulePoints(const BasicCapsule<double>& capsule, vector<double>& drawnPoints);
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <vector>
+
+#include "World.h"
+
+const double DRAW_ANGLE_STEP = PI / 16.0;
+
+// Triangle list (x, y pairs) used to draw a circle, appended to drawnPoints.
+// Points are produced in the world's scalar so they can be uploaded without conversion.
+template <typename Scalar>
+void generateCirclePoints(Scalar posX, Scalar posY, Scalar radius, std::vector<Scalar>& drawnPoints);
+
+// Triangle list (x, y pairs) used to draw a capsule: both end caps and the rectangle joining them.
+template <typename Scalar>
+void generateCapsulePoints(const BasicCapsule<Scalar>& capsule, std::vector<Scalar>& drawnPoints);
@@ -0,0 +1,880 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <fstream>
+#include <limits>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "World.h"
+#include "SimdKernels.h"
+#include "Trace.h"
+#include "Validation.h"
+#include "InputRecording.h"
+
+using namespace std;
+
+// --cross-check defaults. Rounding differences between float and double grow without bound once circles collide, so
+// the scene is compared on its energy and momentum only, every frame. Positions and speeds are compared on a short run
+// of one circle that touches nothing.
+const int CROSS_CHECK_FRAMES = 60;
+const double CROSS_CHECK_ABSOLUTE_TOLERANCE = 1e-1;
+const double CROSS_CHECK_RELATIVE_TOLERANCE = 1e-3;
+const double CROSS_CHECK_ENERGY_DRIFT = 5e-2;
+const double CROSS_CHECK_MOMENTUM_DRIFT = 3e-1;
+
+struct HeadlessOptions
+{
+    int numCircles = 50;
+    int numCapsules = 1;
+
+    int frames = 600;
+    bool framesGiven = false;
+    int warmupFrames = 10;
+
+    double frameDeltaTime = 1.0 / 60.0;
+    int numberOfSimulations = NUMBER_OF_SIMULATIONS;
+    bool substepsGiven = false;
+
+    bool adaptiveSubsteps = false;
+    double substepSafetyFactor = SUBSTEP_SAFETY_FACTOR;
+    int minSubsteps = MIN_ADAPTIVE_SUBSTEPS;
+    int maxSubsteps = MAX_ADAPTIVE_SUBSTEPS;
+
+    bool multirateStepping = false;
+
+    string frameLogPath;
+
+    bool continuousCollisions = false;
+
+    unsigned int seed = 0;
+
+    string tracePath;
+
+    string recordGoldenPath;
+    string checkGoldenPath;
+
+    GoldenTolerances tolerances;
+    GoldenTolerances crossTolerances = { CROSS_CHECK_ABSOLUTE_TOLERANCE, CROSS_CHECK_RELATIVE_TOLERANCE, CROSS_CHECK_ENERGY_DRIFT, CROSS_CHECK_MOMENTUM_DRIFT };
+
+    string replayPath;
+
+    int churn = 0;
+
+    bool useFloat = false;
+    bool crossCheck = false;
+    bool reorderCheck = false;
+
+    CircleBroadphase circleBroadphase = CIRCLE_BROADPHASE_AUTO;
+    CapsuleBroadphase capsuleBroadphase = CAPSULE_BROADPHASE_AABB_TREE;
+
+    double verletSkin = VERLET_SKIN;
+
+    int reorderInterval = 0;
+
+    bool sleeping = false;
+
+    ContactSolver contactSolver = CONTACT_SOLVER_PROJECTION;
+    int contactIterations = CONTACT_ITERATIONS;
+    double contactCompliance = XPBD_CONTACT_COMPLIANCE;
+
+    ContactParallelism contactParallelism = CONTACT_PARALLELISM_NONE;
+    int contactThreads = 0;
+
+    double minRadius = SPAWN_MIN_RADIUS;
+    double maxRadius = SPAWN_MAX_RADIUS;
+};
+
+void printUsage(const char* programName)
+{
+    cout << "Usage: " << programName << " [options]\n"
+        << "  --circles N           number of circles (default 50)\n"
+        << "  --capsules N          number of capsules (default 1)\n"
+        << "  --frames N            number of measured frames (default 600)\n"
+        << "  --warmup N            number of unmeasured frames run first (default 10)\n"
+        << "  --dt SECONDS          fixed frame delta time (default 1/60)\n"
+        << "  --substeps N          substeps per frame (default " << NUMBER_OF_SIMULATIONS << ", " << IMPULSE_SOLVER_SUBSTEPS << " with --solver impulses, " << XPBD_SUBSTEPS << " with --solver xpbd)\n"
+        << "  --adaptive-substeps   pick every frame's substep count from the fastest circle and the smallest radius instead\n"
+        << "  --substep-safety X    fraction of the smallest radius a circle may move per adaptive substep (default " << SUBSTEP_SAFETY_FACTOR << ")\n"
+        << "  --min-substeps N      fewest adaptive substeps per frame (default " << MIN_ADAPTIVE_SUBSTEPS << ")\n"
+        << "  --max-substeps N      most adaptive substeps per frame (default " << MAX_ADAPTIVE_SUBSTEPS << ")\n"
+        << "  --multirate           step slow circles only every 2^k substeps, each at a level picked from its speed and contacts\n"
+        << "  --frame-log FILE      write every measured frame's substep count and milliseconds as CSV\n"
+        << "  --seed N              scene seed (default 0)\n"
+        << "  --radius MIN,MAX      radius range of spawned circles (default " << SPAWN_MIN_RADIUS << "," << SPAWN_MAX_RADIUS << ")\n"
+        << "  --trace FILE          write a Chrome trace of the measured frames (needs PHYSICS_TRACING)\n"
+        << "  --record-golden FILE  record every frame's state as a reference trajectory\n"
+        << "  --check-golden FILE   rerun a recorded scene and diff every frame against it\n"
+        << "  --abs-tol X           absolute tolerance for --check-golden (default 1e-6, " << CROSS_CHECK_ABSOLUTE_TOLERANCE << " with --cross-check)\n"
+        << "  --rel-tol X           relative tolerance for --check-golden (default 1e-6, " << CROSS_CHECK_RELATIVE_TOLERANCE << " with --cross-check)\n"
+        << "  --energy-drift X      allowed relative energy difference per frame (default 1e-3, " << CROSS_CHECK_ENERGY_DRIFT << " with --cross-check)\n"
+        << "  --momentum-drift X    allowed relative momentum difference per frame (default 1e-3, " << CROSS_CHECK_MOMENTUM_DRIFT << " with --cross-check)\n"
+        << "  --replay FILE         replay a recorded input stream (scene, frame count and delta times come from it)\n"
+        << "  --churn N             despawn and respawn N random circles every frame\n"
+        << "  --scalar float|double precision the world is simulated in (default double)\n"
+        << "  --broadphase NAME     circle-circle candidate search: auto, all-pairs, grid, sweep, tree, verlet or hgrid (default auto)\n"
+        << "  --capsule-broadphase NAME  circle-capsule candidate search: all-pairs, sweep or tree (default tree)\n"
+        << "  --verlet-skin X       skin of the verlet broadphase in world units (default " << VERLET_SKIN << ")\n"
+        << "  --reorder K           sort circles along a Morton curve every K frames (default 0, off)\n"
+        << "  --sleep               let settled circles fall asleep until something wakes them\n"
+        << "  --ccd                 sweep fast circles and stop them at their first impact (continuous collision detection)\n"
+        << "  --solver NAME         contact solver: projection, impulses or xpbd (default projection)\n"
+        << "  --iterations N        iterations per substep of the impulse and xpbd solvers (default " << CONTACT_ITERATIONS << ")\n"
+        << "  --compliance X        contact compliance of the xpbd solver (default " << XPBD_CONTACT_COMPLIANCE << ", rigid)\n"
+        << "  --parallel-contacts MODE  spread circle-circle contacts over threads: none, colored or islands (default none)\n"
+        << "  --threads N           threads for --parallel-contacts (default: one per hardware thread)\n"
+        << "  --cross-check         run float and double worlds side by side and diff float against double every frame: positions\n"
+        << "                        on one circle, energy and momentum on the scene (default " << CROSS_CHECK_FRAMES << " frames)\n"
+        << "  --reorder-check       diff a world that reorders its circles every K frames (every frame without --reorder) against one that never does\n";
+}
+
+bool parseBroadphase(const char* value, CircleBroadphase& circleBroadphase)
+{
+    if (strcmp(value, "auto") == 0)
+        circleBroadphase = CIRCLE_BROADPHASE_AUTO;
+    else if (strcmp(value, "all-pairs") == 0)
+        circleBroadphase = CIRCLE_BROADPHASE_ALL_PAIRS;
+    else if (strcmp(value, "grid") == 0)
+        circleBroadphase = CIRCLE_BROADPHASE_GRID;
+    else if (strcmp(value, "sweep") == 0)
+        circleBroadphase = CIRCLE_BROADPHASE_SWEEP_AND_PRUNE;
+    else if (strcmp(value, "tree") == 0)
+        circleBroadphase = CIRCLE_BROADPHASE_AABB_TREE;
+    else if (strcmp(value, "verlet") == 0)
+        circleBroadphase = CIRCLE_BROADPHASE_VERLET;
+    else if (strcmp(value, "hgrid") == 0)
+        circleBroadphase = CIRCLE_BROADPHASE_HIERARCHICAL_GRID;
+    else
+        return false;
+
+    return true;
+}
+
+bool parseCapsuleBroadphase(const char* value, CapsuleBroadphase& capsuleBroadphase)
+{
+    if (strcmp(value, "all-pairs") == 0)
+        capsuleBroadphase = CAPSULE_BROADPHASE_ALL_PAIRS;
+    else if (strcmp(value, "sweep") == 0)
+        capsuleBroadphase = CAPSULE_BROADPHASE_SWEEP_AND_PRUNE;
+    else if (strcmp(value, "tree") == 0)
+        capsuleBroadphase = CAPSULE_BROADPHASE_AABB_TREE;
+    else
+        return false;
+
+    return true;
+}
+
+bool parseContactSolver(const char* value, ContactSolver& contactSolver)
+{
+    if (strcmp(value, "projection") == 0)
+        contactSolver = CONTACT_SOLVER_PROJECTION;
+    else if (strcmp(value, "impulses") == 0)
+        contactSolver = CONTACT_SOLVER_IMPULSES;
+    else if (strcmp(value, "xpbd") == 0)
+        contactSolver = CONTACT_SOLVER_XPBD;
+    else
+        return false;
+
+    return true;
+}
+
+bool parseContactParallelism(const char* value, ContactParallelism& contactParallelism)
+{
+    if (strcmp(value, "none") == 0)
+        contactParallelism = CONTACT_PARALLELISM_NONE;
+    else if (strcmp(value, "colored") == 0)
+        contactParallelism = CONTACT_PARALLELISM_COLORED;
+    else if (strcmp(value, "islands") == 0)
+        contactParallelism = CONTACT_PARALLELISM_ISLANDS;
+    else
+        return false;
+
+    return true;
+}
+
+bool parseOptions(int argc, char** argv, HeadlessOptions& options)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--help") == 0)
+            return false;
+
+        if (strcmp(argv[i], "--cross-check") == 0)
+        {
+            options.crossCheck = true;
+            continue;
+        }
+
+        if (strcmp(argv[i], "--reorder-check") == 0)
+        {
+            options.reorderCheck = true;
+            continue;
+        }
+
+        if (strcmp(argv[i], "--adaptive-substeps") == 0)
+        {
+            options.adaptiveSubsteps = true;
+            continue;
+        }
+
+        if (strcmp(argv[i], "--multirate") == 0)
+        {
+            options.multirateStepping = true;
+            continue;
+        }
+
+        if (strcmp(argv[i], "--ccd") == 0)
+        {
+            options.continuousCollisions = true;
+            continue;
+        }
+
+        if (strcmp(argv[i], "--sleep") == 0)
+        {
+            options.sleeping = true;
+            continue;
+        }
+
+        if (i + 1 >= argc)
+        {
+            cerr << "Missing value for " << argv[i] << "\n";
+            return false;
+        }
+
+        const char* value = argv[++i];
+
+        if (strcmp(argv[i - 1], "--circles") == 0)
+            options.numCircles = atoi(value);
+        else if (strcmp(argv[i - 1], "--capsules") == 0)
+            options.numCapsules = atoi(value);
+        else if (strcmp(argv[i - 1], "--frames") == 0)
+        {
+            options.frames = atoi(value);
+            options.framesGiven = true;
+        }
+        else if (strcmp(argv[i - 1], "--warmup") == 0)
+            options.warmupFrames = atoi(value);
+        else if (strcmp(argv[i - 1], "--dt") == 0)
+            options.frameDeltaTime = atof(value);
+        else if (strcmp(argv[i - 1], "--substeps") == 0)
+        {
+            options.numberOfSimulations = atoi(value);
+            options.substepsGiven = true;
+        }
+        else if (strcmp(argv[i - 1], "--substep-safety") == 0)
+            options.substepSafetyFactor = atof(value);
+        else if (strcmp(argv[i - 1], "--min-substeps") == 0)
+            options.minSubsteps = atoi(value);
+        else if (strcmp(argv[i - 1], "--max-substeps") == 0)
+            options.maxSubsteps = atoi(value);
+        else if (strcmp(argv[i - 1], "--frame-log") == 0)
+            options.frameLogPath = value;
+        else if (strcmp(argv[i - 1], "--seed") == 0)
+            options.seed = (unsigned int)strtoul(value, nullptr, 10);
+        else if (strcmp(argv[i - 1], "--trace") == 0)
+            options.tracePath = value;
+        else if (strcmp(argv[i - 1], "--record-golden") == 0)
+            options.recordGoldenPath = value;
+        else if (strcmp(argv[i - 1], "--check-golden") == 0)
+            options.checkGoldenPath = value;
+        else if (strcmp(argv[i - 1], "--abs-tol") == 0)
+        {
+            options.tolerances.absoluteTolerance = atof(value);
+            options.crossTolerances.absoluteTolerance = options.tolerances.absoluteTolerance;
+        }
+        else if (strcmp(argv[i - 1], "--rel-tol") == 0)
+        {
+            options.tolerances.relativeTolerance = atof(value);
+            options.crossTolerances.relativeTolerance = options.tolerances.relativeTolerance;
+        }
+        else if (strcmp(argv[i - 1], "--energy-drift") == 0)
+        {
+            options.tolerances.energyDrift = atof(value);
+            options.crossTolerances.energyDrift = options.tolerances.energyDrift;
+        }
+        else if (strcmp(argv[i - 1], "--momentum-drift") == 0)
+        {
+            options.tolerances.momentumDrift = atof(value);
+            options.crossTolerances.momentumDrift = options.tolerances.momentumDrift;
+        }
+        else if (strcmp(argv[i - 1], "--replay") == 0)
+            options.replayPath = value;
+        else if (strcmp(argv[i - 1], "--churn") == 0)
+            options.churn = atoi(value);
+        else if (strcmp(argv[i - 1], "--broadphase") == 0)
+        {
+            if (!parseBroadphase(value, options.circleBroadphase))
+            {
+                cerr << "Invalid broadphase " << value << "\n";
+                return false;
+            }
+        }
+        else if (strcmp(argv[i - 1], "--radius") == 0)
+        {
+            if (sscanf(value, "%lf,%lf", &options.minRadius, &options.maxRadius) != 2 || options.minRadius <= 0.0 || options.maxRadius < options.minRadius)
+            {
+                cerr << "Invalid radius range " << value << "\n";
+                return false;
+            }
+        }
+        else if (strcmp(argv[i - 1], "--reorder") == 0)
+            options.reorderInterval = atoi(value);
+        else if (strcmp(argv[i - 1], "--verlet-skin") == 0)
+            options.verletSkin = atof(value);
+        else if (strcmp(argv[i - 1], "--solver") == 0)
+        {
+            if (!parseContactSolver(value, options.contactSolver))
+            {
+                cerr << "Invalid contact solver " << value << "\n";
+                return false;
+            }
+        }
+        else if (strcmp(argv[i - 1], "--iterations") == 0)
+            options.contactIterations = atoi(value);
+        else if (strcmp(argv[i - 1], "--compliance") == 0)
+            options.contactCompliance = atof(value);
+        else if (strcmp(argv[i - 1], "--parallel-contacts") == 0)
+        {
+            if (!parseContactParallelism(value, options.contactParallelism))
+            {
+                cerr << "Invalid contact parallelism " << value << "\n";
+                return false;
+            }
+        }
+        else if (strcmp(argv[i - 1], "--threads") == 0)
+            options.contactThreads = atoi(value);
+        else if (strcmp(argv[i - 1], "--capsule-broadphase") == 0)
+        {
+            if (!parseCapsuleBroadphase(value, options.capsuleBroadphase))
+            {
+                cerr << "Invalid capsule broadphase " << value << "\n";
+                return false;
+            }
+        }
+        else if (strcmp(argv[i - 1], "--scalar") == 0)
+        {
+            if (strcmp(value, "float") == 0)
+                options.useFloat = true;
+            else if (strcmp(value, "double") == 0)
+                options.useFloat = false;
+            else
+            {
+                cerr << "Invalid scalar " << value << "\n";
+                return false;
+            }
+        }
+        else
+        {
+            cerr << "Unknown option " << argv[i - 1] << "\n";
+            return false;
+        }
+    }
+
+    if (options.numCircles < 0 || options.numCapsules < 0 || options.frames <= 0 || options.warmupFrames < 0 || options.numberOfSimulations <= 0 || options.frameDeltaTime <= 0.0 || options.churn < 0 || options.contactThreads < 0 || options.contactIterations <= 0 || options.contactCompliance < 0.0 || options.substepSafetyFactor <= 0.0 || options.minSubsteps <= 0 || options.maxSubsteps < options.minSubsteps)
+    {
+        cerr << "Invalid option value\n";
+        return false;
+    }
+
+    if (options.contactSolver == CONTACT_SOLVER_IMPULSES && !options.substepsGiven)
+        options.numberOfSimulations = IMPULSE_SOLVER_SUBSTEPS;
+
+    if (options.contactSolver == CONTACT_SOLVER_XPBD && !options.substepsGiven)
+        options.numberOfSimulations = XPBD_SUBSTEPS;
+
+    if (options.crossCheck && !options.framesGiven)
+        options.frames = CROSS_CHECK_FRAMES;
+
+    if (options.crossCheck && (options.churn > 0 || !options.recordGoldenPath.empty() || !options.checkGoldenPath.empty()))
+    {
+        cerr << "--cross-check cannot be combined with --churn or golden files\n";
+        return false;
+    }
+
+    if (options.reorderCheck && (options.crossCheck || options.churn > 0 || !options.recordGoldenPath.empty() || !options.checkGoldenPath.empty()))
+    {
+        cerr << "--reorder-check cannot be combined with --cross-check, --churn or golden files\n";
+        return false;
+    }
+
+    return true;
+}
+
+// Applies every option that selects an implementation or a setting of the world, before the scene is created.
+template <typename Scalar>
+void configureWorld(BasicWorld<Scalar>& world, const HeadlessOptions& options)
+{
+    world.numberOfSimulations = options.numberOfSimulations;
+    world.circleBroadphase = options.circleBroadphase;
+    world.capsuleBroadphase = options.capsuleBroadphase;
+    world.circleVerlet.skin = Scalar(options.verletSkin);
+    world.reorderInterval = options.reorderInterval;
+    world.sleepingEnabled = options.sleeping;
+    world.contactSolver = options.contactSolver;
+    world.contactIterations = options.contactIterations;
+    world.contactCompliance = Scalar(options.contactCompliance);
+    world.contactParallelism = options.contactParallelism;
+    world.adaptiveSubsteps = options.adaptiveSubsteps;
+    world.substepSafetyFactor = Scalar(options.substepSafetyFactor);
+    world.minSubsteps = options.minSubsteps;
+    world.maxSubsteps = options.maxSubsteps;
+    world.multirateStepping = options.multirateStepping;
+    world.continuousCollisions = options.continuousCollisions;
+
+    if (options.contactThreads > 0)
+        world.contactThreads = options.contactThreads;
+}
+
+// Prints what a comparator saw and returns whether every frame was within tolerance.
+bool printComparison(const char* name, const GoldenComparator& comparator)
+{
+    cout << name << " frames compared: " << comparator.framesCompared << "\n";
+    cout << name << " frames failed: " << comparator.failedFrames << "\n";
+    cout << "max absolute error: " << comparator.maxAbsoluteError << "\n";
+    cout << "max relative error: " << comparator.maxRelativeError << "\n";
+    cout << "max energy drift: " << comparator.maxEnergyDrift << "\n";
+    cout << "max momentum drift: " << comparator.maxMomentumDrift << "\n";
+
+    if (!comparator.passed())
+    {
+        cout << name << " check FAILED, first failure: " << comparator.firstFailure << "\n";
+        return false;
+    }
+
+    cout << name << " check passed\n";
+
+    return true;
+}
+
+// One headless run in the given precision; golden files, if any, decide the scene.
+template <typename Scalar>
+int runHeadless(HeadlessOptions options, const InputRecording& inputRecording)
+{
+    GoldenReader goldenReader;
+    GoldenWriter goldenWriter;
+
+    if (!options.checkGoldenPath.empty())
+    {
+        if (!goldenReader.open(options.checkGoldenPath))
+        {
+            cerr << "Could not read golden file " << options.checkGoldenPath << "\n";
+            return 1;
+        }
+
+        // The reference decides the scene; only the implementation under test (and, if asked, the substep count) may differ.
+        options.numCircles = goldenReader.header.numCircles;
+        options.numCapsules = goldenReader.header.numCapsules;
+        options.frames = goldenReader.header.frames;
+        options.frameDeltaTime = goldenReader.header.frameDeltaTime;
+        options.seed = goldenReader.header.seed;
+        options.minRadius = goldenReader.header.minRadius;
+        options.maxRadius = goldenReader.header.maxRadius;
+
+        if (!options.substepsGiven)
+            options.numberOfSimulations = goldenReader.header.numberOfSimulations;
+    }
+
+    if (!options.checkGoldenPath.empty() || !options.recordGoldenPath.empty())
+        options.warmupFrames = 0;
+
+    if (!options.recordGoldenPath.empty())
+    {
+        GoldenHeader header;
+
+        header.numCircles = options.numCircles;
+        header.numCapsules = options.numCapsules;
+        header.frames = options.frames;
+        header.numberOfSimulations = options.numberOfSimulations;
+        header.frameDeltaTime = options.frameDeltaTime;
+        header.seed = options.seed;
+        header.minRadius = options.minRadius;
+        header.maxRadius = options.maxRadius;
+
+        if (!goldenWriter.open(options.recordGoldenPath, header))
+        {
+            cerr << "Could not write golden file " << options.recordGoldenPath << "\n";
+            return 1;
+        }
+    }
+
+    GoldenComparator goldenComparator;
+    goldenComparator.tolerances = options.tolerances;
+
+    vector<double> reference;
+
+    BasicWorld<Scalar> world;
+    configureWorld(world, options);
+
+    createDefaultScene(world, options.numCircles, options.numCapsules, options.seed, options.minRadius, options.maxRadius);
+
+    InputPlayer inputPlayer(&inputRecording);
+
+    if (!options.replayPath.empty())
+        world.inputPlayer = &inputPlayer;
+
+    InputState input;
+
+    vector<BodyHandle> despawned;
+    vector<BasicCircle<Scalar>> spawned;
+
+    for (int frame = 0; frame < options.warmupFrames; frame++)
+        world.simulate(options.frameDeltaTime, input);
+
+    double awakeCircleFrames = 0.0;
+
+    ofstream frameLog;
+
+    if (!options.frameLogPath.empty())
+    {
+        frameLog.open(options.frameLogPath);
+
+        if (!frameLog)
+        {
+            cerr << "Could not write frame log " << options.frameLogPath << "\n";
+            return 1;
+        }
+
+        frameLog << "frame,substeps,milliseconds\n";
+    }
+
+    double totalSteps = 0.0;
+    int minFrameSubsteps = 0;
+    int maxFrameSubsteps = 0;
+
+    long long sweptCircles = 0;
+    long long timeOfImpactHits = 0;
+    long long movingCapsuleHits = 0;
+
+    double multirateCircleSteps = 0.0;
+    double fullRateCircleSteps = 0.0;
+    long long promotedCircles = 0;
+
+    auto startTime = chrono::steady_clock::now();
+
+    for (int frame = 0; frame < options.frames; frame++)
+    {
+        TRACE_SCOPE_INDEX("frame", frame);
+
+        if (options.churn > 0)
+        {
+            despawned.clear();
+            spawned.clear();
+
+            for (int k = 0; k < options.churn && k < world.circles.size(); k++)
+            {
+                int i = rand() % world.circles.size();
+
+                if (!world.circleColdData[i].playerControlled)
+                    despawned.push_back(world.circleRegistry.handleAt(i));
+            }
+
+            int removed = world.removeCircles(despawned);
+
+            for (int k = 0; k < removed; k++)
+                spawned.push_back(createRandomCircle(world, options.minRadius, options.maxRadius));
+
+            world.addCircles(spawned);
+        }
+
+        auto frameStartTime = chrono::steady_clock::now();
+
+        world.simulate(options.frameDeltaTime, input);
+
+        if (frameLog.is_open())
+            frameLog << frame << "," << world.frameSubsteps << "," << chrono::duration<double, milli>(chrono::steady_clock::now() - frameStartTime).count() << "\n";
+
+        totalSteps += world.frameSubsteps;
+        minFrameSubsteps = frame == 0 ? world.frameSubsteps : min(minFrameSubsteps, world.frameSubsteps);
+        maxFrameSubsteps = max(maxFrameSubsteps, world.frameSubsteps);
+
+        sweptCircles += world.sweptCircles;
+        timeOfImpactHits += world.timeOfImpactHits;
+        movingCapsuleHits += world.movingCapsuleHits;
+
+        multirateCircleSteps += world.multirateCircleSteps;
+        fullRateCircleSteps += (double)world.frameSubsteps * world.circles.size();
+        promotedCircles += world.promotedCircles;
+
+        awakeCircleFrames += world.numAwakeCircles;
+
+        if (!options.recordGoldenPath.empty())
+            goldenWriter.writeFrame(world);
+
+        if (!options.checkGoldenPath.empty())
+        {
+            if (!goldenReader.readFrame(reference))
+            {
+                cerr << "Golden file " << options.checkGoldenPath << " ends before frame " << frame << "\n";
+                return 1;
+            }
+
+            goldenComparator.compareFrame(frame, world, reference);
+        }
+    }
+
+    auto endTime = chrono::steady_clock::now();
+
+    double elapsedSeconds = chrono::duration<double>(endTime - startTime).count();
+
+    double totalBodySteps = totalSteps * (options.numCircles + options.numCapsules);
+
+    cout << "circles: " << options.numCircles << "\n";
+    cout << "capsules: " << options.numCapsules << "\n";
+    cout << "frames: " << options.frames << "\n";
+
+    if (options.adaptiveSubsteps)
+        cout << "substeps per frame: adaptive, mean " << totalSteps / options.frames << ", min " << minFrameSubsteps << ", max " << maxFrameSubsteps << "\n";
+    else
+        cout << "substeps per frame: " << options.numberOfSimulations << "\n";
+
+    cout << "scalar: " << (sizeof(Scalar) == sizeof(float) ? "float" : "double") << "\n";
+    cout << "simd: " << simdInstructionSet() << ", " << simdLanes<Scalar>() << " lanes\n";
+    cout << "elapsed seconds: " << elapsedSeconds << "\n";
+    cout << "frames/sec: " << options.frames / elapsedSeconds << "\n";
+    cout << "steps/sec: " << totalSteps / elapsedSeconds << "\n";
+
+    if (totalBodySteps > 0.0)
+        cout << "ns per body-step: " << elapsedSeconds * 1e9 / totalBodySteps << "\n";
+
+    if (options.sleeping)
+    {
+        cout << "mean awake circles: " << (options.frames > 0 ? awakeCircleFrames / options.frames : 0.0) << "\n";
+        cout << "awake circles at the end: " << world.numAwakeCircles << " of " << world.circles.size() << "\n";
+    }
+
+    if (options.continuousCollisions)
+        cout << "swept circles: " << sweptCircles << ", stopped at an impact: " << timeOfImpactHits << "\n";
+
+    if (options.multirateStepping)
+    {
+        cout << "multirate circle substeps per frame: " << multirateCircleSteps / options.frames << ", " << (fullRateCircleSteps > 0.0 ? 100.0 * multirateCircleSteps / fullRateCircleSteps : 0.0) << "% of every circle at every substep\n";
+        cout << "circles moved to the finest level: " << promotedCircles << "\n";
+    }
+
+    if (movingCapsuleHits > 0)
+        cout << "circles caught by a moving capsule: " << movingCapsuleHits << "\n";
+
+    if (options.contactSolver == CONTACT_SOLVER_IMPULSES)
+    {
+        const ImpulseSolver<Scalar>& solver = world.impulseSolver;
+
+        cout << "contacts in the last substep: " << solver.contacts.size() << ", " << solver.warmStartedContacts << " warm started\n";
+        cout << "deepest overlap in the last substep: " << solver.maxPenetration << "\n";
+    }
+
+    if (options.contactSolver == CONTACT_SOLVER_XPBD)
+    {
+        const XpbdSolver<Scalar>& solver = world.xpbdSolver;
+
+        cout << "contacts in the last substep: " << solver.contacts.size() << "\n";
+        cout << "deepest overlap in the last substep: " << solver.maxPenetration << "\n";
+    }
+
+    if (options.contactParallelism == CONTACT_PARALLELISM_COLORED)
+    {
+        const ContactColoring& coloring = world.contactColoring;
+
+        cout << "contact threads: " << world.contactThreadPool.size() << "\n";
+        cout << "contacts in the last pass: " << coloring.pairA.size() << " in " << coloring.numBatches << " batches" << (coloring.overflowBatch ? " (last one serial)" : "") << "\n";
+    }
+
+    if (options.contactParallelism == CONTACT_PARALLELISM_ISLANDS)
+    {
+        const ContactIslands& islands = world.contactIslands;
+
+        cout << "contact threads: " << world.contactThreadPool.size() << "\n";
+        cout << "contacts in the last pass: " << islands.pairA.size() << " in " << islands.numIslands << " islands, "
+            << islands.numSingleBodyIslands << " of them a single circle against sleeping ones\n";
+
+        if (islands.numIslands > 0)
+            cout << "largest island: " << islands.islandStart[1] - islands.islandStart[0] << " contacts\n";
+    }
+
+    if (options.circleBroadphase == CIRCLE_BROADPHASE_VERLET)
+    {
+        const VerletList<Scalar>& verlet = world.circleVerlet;
+
+        cout << "verlet skin: " << verlet.skin << "\n";
+        cout << "verlet rebuilds: " << verlet.rebuilds << " of " << verlet.updates << " passes\n";
+        cout << "verlet passes finished on the grid: " << verlet.invalidations << "\n";
+        cout << "verlet pairs per circle: " << (world.circles.size() > 0 ? 1.0 * verlet.partners.size() / world.circles.size() : 0.0) << "\n";
+    }
+
+    if (!options.checkGoldenPath.empty() && !printComparison("golden", goldenComparator))
+        return 2;
+
+    if (!options.tracePath.empty() && !traceWriteChromeJson(options.tracePath.c_str()))
+    {
+        cerr << "Could not write trace to " << options.tracePath << (TRACING_ENABLED ? "" : " (build with PHYSICS_TRACING)") << "\n";
+        return 1;
+    }
+
+    return 0;
+}
+
+// Steps a reference world and a world under test through the same scene and input, and diffs the second against the
+// first every frame after the warmup. setup(referenceWorld, world) runs after configureWorld, before the scene is created.
+template <typename ReferenceScalar, typename Scalar, typename Setup>
+void compareWorlds(const HeadlessOptions& options, const InputRecording& inputRecording, const Setup& setup, GoldenComparator& comparator)
+{
+    BasicWorld<ReferenceScalar> referenceWorld;
+    BasicWorld<Scalar> world;
+
+    configureWorld(referenceWorld, options);
+    configureWorld(world, options);
+
+    setup(referenceWorld, world);
+
+    createDefaultScene(referenceWorld, options.numCircles, options.numCapsules, options.seed, options.minRadius, options.maxRadius);
+    createDefaultScene(world, options.numCircles, options.numCapsules, options.seed, options.minRadius, options.maxRadius);
+
+    InputPlayer referenceInputPlayer(&inputRecording);
+    InputPlayer inputPlayer(&inputRecording);
+
+    if (!options.replayPath.empty())
+    {
+        referenceWorld.inputPlayer = &referenceInputPlayer;
+        world.inputPlayer = &inputPlayer;
+    }
+
+    vector<double> reference;
+
+    InputState input;
+
+    for (int frame = 0; frame < options.warmupFrames + options.frames; frame++)
+    {
+        referenceWorld.simulate(options.frameDeltaTime, input);
+        world.simulate(options.frameDeltaTime, input);
+
+        if (frame < options.warmupFrames)
+            continue;
+
+        captureState(referenceWorld, reference);
+
+        comparator.compareFrame(frame - options.warmupFrames, world, reference);
+    }
+
+    cout << "circles: " << world.circles.size() << "\n";
+    cout << "capsules: " << world.capsules.size() << "\n";
+    cout << "frames: " << options.frames << "\n";
+}
+
+// The circle of the --cross-check position run: dropped from a quarter of the height with a sideways speed, it stays
+// clear of the walls for CROSS_CHECK_FRAMES frames.
+template <typename Scalar>
+void addCrossCheckCircle(BasicWorld<Scalar>& world)
+{
+    world.addCircles({ BasicCircle<Scalar>(0, world.height / 4, 20, 1.0, 0.0, 0.0, 1, 100, 0) });
+}
+
+// Steps a double and a float world side by side, using the double one as the reference: first one circle that touches
+// nothing, diffed on every value, then the scene with its input, diffed on energy and momentum alone.
+int crossCheckScalars(const HeadlessOptions& options, const InputRecording& inputRecording)
+{
+    HeadlessOptions positionOptions = options;
+
+    positionOptions.numCircles = 0;
+    positionOptions.numCapsules = 0;
+    positionOptions.frames = min(options.frames, CROSS_CHECK_FRAMES);
+    positionOptions.warmupFrames = 0;
+    positionOptions.replayPath.clear();
+
+    GoldenComparator positionComparator;
+    positionComparator.tolerances = options.crossTolerances;
+
+    compareWorlds<double, float>(positionOptions, inputRecording, [](BasicWorld<double>& referenceWorld, BasicWorld<float>& world)
+    {
+        addCrossCheckCircle(referenceWorld);
+        addCrossCheckCircle(world);
+    }, positionComparator);
+
+    bool positionsPassed = printComparison("cross position", positionComparator);
+
+    GoldenComparator sceneComparator;
+    sceneComparator.tolerances = options.crossTolerances;
+    sceneComparator.tolerances.absoluteTolerance = numeric_limits<double>::infinity();
+
+    compareWorlds<double, float>(options, inputRecording, [](BasicWorld<double>&, BasicWorld<float>&) {}, sceneComparator);
+
+    if (options.adaptiveSubsteps)
+        cout << "substeps per frame: adaptive\n";
+    else
+        cout << "substeps per frame: " << options.numberOfSimulations << "\n";
+
+    bool scenePassed = printComparison("cross energy", sceneComparator);
+
+    return positionsPassed && scenePassed ? 0 : 2;
+}
+
+// Steps two double worlds through the same scene and input, one never reordering its circles and one reordering them
+// every K frames, and diffs the second against the first. Golden captures follow the registry, not the storage order,
+// so the two only differ where the new order changes which contacts are resolved first: scenes whose contacts do not
+// chain through shared circles match exactly.
+int checkReordering(const HeadlessOptions& options, const InputRecording& inputRecording)
+{
+    GoldenComparator comparator;
+    comparator.tolerances = options.tolerances;
+
+    int reorderInterval = max(options.reorderInterval, 1);
+
+    compareWorlds<double, double>(options, inputRecording, [&](BasicWorld<double>& referenceWorld, BasicWorld<double>& world)
+    {
+        referenceWorld.reorderInterval = 0;
+        world.reorderInterval = reorderInterval;
+    }, comparator);
+
+    cout << "reorder every: " << reorderInterval << " frames\n";
+
+    return printComparison("reorder", comparator) ? 0 : 2;
+}
+
+int main(int argc, char** argv)
+{
+    HeadlessOptions options;
+
+    if (!parseOptions(argc, argv, options))
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    InputRecording inputRecording;
+
+    if (!options.replayPath.empty())
+    {
+        if (!inputRecording.load(options.replayPath))
+        {
+            cerr << "Could not read input recording " << options.replayPath << "\n";
+            return 1;
+        }
+
+        options.numCircles = inputRecording.numCircles;
+        options.numCapsules = inputRecording.numCapsules;
+        options.seed = inputRecording.seed;
+        options.frames = inputRecording.frameDeltaTimes.size();
+        options.warmupFrames = 0;
+
+        if (!options.substepsGiven)
+            options.numberOfSimulations = inputRecording.numberOfSimulations;
+
+        if (options.frames == 0)
+        {
+            cerr << "Input recording " << options.replayPath << " has no frames\n";
+            return 1;
+        }
+    }
+
+    if (options.crossCheck)
+        return crossCheckScalars(options, inputRecording);
+
+    if (options.reorderCheck)
+        return checkReordering(options, inputRecording);
+
+    if (options.useFloat)
+        return runHeadless<float>(options, inputRecording);
+
+    return runHeadless<double>(options, inputRecording);
+}
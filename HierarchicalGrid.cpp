@@ -0,0 +1,181 @@
+#include "HierarchicalGrid.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+template <typename Scalar>
+void HierarchicalGrid<Scalar>::build(const Scalar* posX, const Scalar* posY, const Scalar* radius, int numBodies, Scalar margin)
+{
+    this->minRadius = numBodies > 0 ? radius[0] : Scalar(0);
+
+    for (int i = 1; i < numBodies; i++)
+        this->minRadius = min(this->minRadius, radius[i]);
+
+    this->bodyLevel.resize(numBodies);
+    this->bodyBucket.resize(numBodies);
+
+    int numLevels = 0;
+
+    for (int i = 0; i < numBodies; i++)
+    {
+        int level = 0;
+
+        if (this->minRadius > 0)
+        {
+            for (Scalar bound = 2 * this->minRadius; radius[i] >= bound; bound *= 2)
+                level++;
+        }
+
+        this->bodyLevel[i] = level;
+        numLevels = max(numLevels, level + 1);
+    }
+
+    this->levels.resize(numLevels);
+
+    vector<int> levelCount(numLevels, 0);
+    vector<Scalar> levelMaxRadius(numLevels, Scalar(0));
+
+    for (int i = 0; i < numBodies; i++)
+    {
+        levelCount[this->bodyLevel[i]]++;
+        levelMaxRadius[this->bodyLevel[i]] = max(levelMaxRadius[this->bodyLevel[i]], radius[i]);
+    }
+
+    for (int l = 0; l < numLevels; l++)
+    {
+        Level& level = this->levels[l];
+
+        level.cellSize = levelMaxRadius[l] > 0 ? 2 * levelMaxRadius[l] * (1 + margin) : Scalar(1);
+
+        // At least two buckets per body keeps chains short.
+        int numBuckets = 1;
+
+        while (numBuckets < 2 * levelCount[l])
+            numBuckets *= 2;
+
+        level.bucketMask = numBuckets - 1;
+
+        level.bucketStart.assign(numBuckets + 1, 0);
+        level.bodies.resize(levelCount[l]);
+        level.cellX.resize(levelCount[l]);
+        level.cellY.resize(levelCount[l]);
+    }
+
+    for (int i = 0; i < numBodies; i++)
+    {
+        Level& level = this->levels[this->bodyLevel[i]];
+
+        int bucket = this->bucket(level, this->cellCoordinate(level, posX[i]), this->cellCoordinate(level, posY[i]));
+
+        this->bodyBucket[i] = bucket;
+        level.bucketStart[bucket + 1]++;
+    }
+
+    for (int l = 0; l < numLevels; l++)
+    {
+        Level& level = this->levels[l];
+
+        for (int b = 0; b <= level.bucketMask; b++)
+            level.bucketStart[b + 1] += level.bucketStart[b];
+    }
+
+    // Scatter in index order so every bucket lists its bodies sorted; bucketStart[b] is the write cursor and restored after.
+    for (int i = 0; i < numBodies; i++)
+    {
+        Level& level = this->levels[this->bodyLevel[i]];
+
+        int entry = level.bucketStart[this->bodyBucket[i]]++;
+
+        level.bodies[entry] = i;
+        level.cellX[entry] = this->cellCoordinate(level, posX[i]);
+        level.cellY[entry] = this->cellCoordinate(level, posY[i]);
+    }
+
+    for (int l = 0; l < numLevels; l++)
+    {
+        Level& level = this->levels[l];
+
+        for (int b = level.bucketMask + 1; b > 0; b--)
+            level.bucketStart[b] = level.bucketStart[b - 1];
+
+        level.bucketStart[0] = 0;
+    }
+
+    this->pairLow.clear();
+    this->pairHigh.clear();
+
+    for (int i = 0; i < numBodies; i++)
+    {
+        // The body's own level first, where only partners above i are taken, then every coarser one, which holds only
+        // larger bodies and so has cells wide enough for any pair involving i.
+        for (int l = this->bodyLevel[i]; l < numLevels; l++)
+        {
+            const Level& level = this->levels[l];
+
+            bool ownLevel = l == this->bodyLevel[i];
+
+            int cellX = this->cellCoordinate(level, posX[i]);
+            int cellY = this->cellCoordinate(level, posY[i]);
+
+            for (int y = cellY - 1; y <= cellY + 1; y++)
+            {
+                for (int x = cellX - 1; x <= cellX + 1; x++)
+                {
+                    int bucket = this->bucket(level, x, y);
+
+                    for (int entry = level.bucketStart[bucket]; entry < level.bucketStart[bucket + 1]; entry++)
+                    {
+                        int j = level.bodies[entry];
+
+                        if (level.cellX[entry] != x || level.cellY[entry] != y || (ownLevel && j <= i))
+                            continue;
+
+                        this->pairLow.push_back(min(i, j));
+                        this->pairHigh.push_back(max(i, j));
+                    }
+                }
+            }
+        }
+    }
+
+    // Group by lower body with a counting sort, then order each body's partners.
+    this->pairStart.assign(numBodies + 1, 0);
+
+    for (int p = 0; p < this->pairLow.size(); p++)
+        this->pairStart[this->pairLow[p] + 1]++;
+
+    for (int i = 0; i < numBodies; i++)
+        this->pairStart[i + 1] += this->pairStart[i];
+
+    this->partners.resize(this->pairLow.size());
+
+    for (int p = 0; p < this->pairLow.size(); p++)
+        this->partners[this->pairStart[this->pairLow[p]]++] = this->pairHigh[p];
+
+    for (int i = numBodies; i > 0; i--)
+        this->pairStart[i] = this->pairStart[i - 1];
+
+    this->pairStart[0] = 0;
+
+    for (int i = 0; i < numBodies; i++)
+        sort(this->partners.begin() + this->pairStart[i], this->partners.begin() + this->pairStart[i + 1]);
+}
+
+template <typename Scalar>
+int HierarchicalGrid<Scalar>::cellCoordinate(const Level& level, Scalar x) const
+{
+    return (int)floor(x / level.cellSize);
+}
+
+template <typename Scalar>
+int HierarchicalGrid<Scalar>::bucket(const Level& level, int cellX, int cellY) const
+{
+    unsigned int hash = (unsigned int)cellX * 73856093u ^ (unsigned int)cellY * 19349663u;
+
+    return (int)(hash & (unsigned int)level.bucketMask);
+}
+
+template struct HierarchicalGrid<float>;
+template struct HierarchicalGrid<double>;
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <vector>
+
+// Grids stacked by radius: level L holds the bodies with radius in [minRadius * 2^L, minRadius * 2^(L + 1)), with
+// cells sized for that level's largest body. A body looks for partners in the 3x3 cells around it on its own level
+// and on every coarser level; a partner on a finer level finds it instead. Every pair then lies in cells no smaller
+// than the larger body, however widely the radii vary.
+//
+// Fine levels would need far more cells than bodies to cover the box, so every level hashes its cells into a bucket
+// table sized for its body count, and lookups keep only the bodies whose cell really matches.
+template <typename Scalar>
+struct HierarchicalGrid
+{
+    struct Level
+    {
+        Scalar cellSize;
+
+        int bucketMask;
+
+        // Bodies sorted by bucket: bucket b holds bodies[bucketStart[b]] .. bodies[bucketStart[b + 1] - 1], in
+        // increasing index order, and cellX / cellY hold the cell of each entry.
+        std::vector<int> bucketStart;
+        std::vector<int> bodies;
+        std::vector<int> cellX;
+        std::vector<int> cellY;
+    };
+
+    Scalar minRadius = 0;
+
+    std::vector<Level> levels;
+
+    std::vector<int> bodyLevel;
+    std::vector<int> bodyBucket;
+
+    // Body i's candidates are partners[pairStart[i]] .. partners[pairStart[i + 1] - 1], all above i and in increasing order.
+    std::vector<int> pairStart;
+    std::vector<int> partners;
+
+    // Scratch space: candidate pairs as found, before they are grouped by their lower body.
+    std::vector<int> pairLow;
+    std::vector<int> pairHigh;
+
+    // margin is a fraction of the diameter added to each level's cell size, like UniformGrid::build's.
+    void build(const Scalar* posX, const Scalar* posY, const Scalar* radius, int numBodies, Scalar margin);
+
+    int cellCoordinate(const Level& level, Scalar x) const;
+    int bucket(const Level& level, int cellX, int cellY) const;
+};
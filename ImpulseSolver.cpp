@@ -0,0 +1,213 @@
+#include "ImpulseSolver.h"
+
+#include <algorithm>
+
+using namespace std;
+
+template <typename Scalar>
+void ImpulseSolver<Scalar>::beginContacts(int bodiesVersion)
+{
+    this->previousContacts.swap(this->contacts);
+    this->contacts.clear();
+
+    if (bodiesVersion != this->bodiesVersion)
+    {
+        this->previousContacts.clear();
+        this->bodiesVersion = bodiesVersion;
+    }
+}
+
+template <typename Scalar>
+void ImpulseSolver<Scalar>::addContact(int a, int b, int key, Scalar normalX, Scalar normalY, Scalar separation, Scalar surfaceSpeed, Scalar restitution)
+{
+    ImpulseContact<Scalar> contact;
+
+    contact.a = a;
+    contact.b = b;
+    contact.key = key;
+
+    contact.normalX = normalX;
+    contact.normalY = normalY;
+
+    contact.separation = separation;
+    contact.surfaceSpeed = surfaceSpeed;
+    contact.restitution = restitution;
+
+    contact.effectiveMass = 0;
+    contact.velocityTarget = 0;
+
+    contact.normalImpulse = 0;
+    contact.positionImpulse = 0;
+
+    this->contacts.push_back(contact);
+}
+
+template <typename Scalar>
+void ImpulseSolver<Scalar>::solve(Scalar* posX, Scalar* posY, Scalar* speedX, Scalar* speedY, const Scalar* mass, int numDynamicBodies, Scalar deltaTime, int iterations)
+{
+    int numContacts = (int)this->contacts.size();
+
+    this->warmStartedContacts = 0;
+    this->maxPenetration = 0;
+
+    this->biasSpeedX.assign(numDynamicBodies, Scalar(0));
+    this->biasSpeedY.assign(numDynamicBodies, Scalar(0));
+
+    Scalar* biasSpeedX = this->biasSpeedX.data();
+    Scalar* biasSpeedY = this->biasSpeedY.data();
+
+    // Both lists are in (a, key) order, so one merge finds every contact that persists.
+    int previous = 0;
+
+    for (int c = 0; c < numContacts; c++)
+    {
+        ImpulseContact<Scalar>& contact = this->contacts[c];
+
+        int a = contact.a;
+        int b = contact.b;
+
+        bool dynamicB = b >= 0 && b < numDynamicBodies;
+
+        Scalar inverseMass = 1 / mass[a] + (dynamicB ? 1 / mass[b] : Scalar(0));
+
+        contact.effectiveMass = 1 / inverseMass;
+
+        Scalar normalSpeed = speedX[a] * contact.normalX + speedY[a] * contact.normalY;
+
+        if (dynamicB)
+            normalSpeed -= speedX[b] * contact.normalX + speedY[b] * contact.normalY;
+
+        normalSpeed -= contact.surfaceSpeed;
+
+        if (normalSpeed < -Scalar(RESTITUTION_THRESHOLD))
+            contact.velocityTarget = -contact.restitution * normalSpeed;
+
+        this->maxPenetration = max(this->maxPenetration, -contact.separation);
+
+        while (previous < this->previousContacts.size() && (this->previousContacts[previous].a < a || (this->previousContacts[previous].a == a && this->previousContacts[previous].key < contact.key)))
+            previous++;
+
+        if (previous < this->previousContacts.size() && this->previousContacts[previous].a == a && this->previousContacts[previous].key == contact.key)
+        {
+            contact.normalImpulse = this->previousContacts[previous].normalImpulse;
+
+            speedX[a] += contact.normalX * contact.normalImpulse / mass[a];
+            speedY[a] += contact.normalY * contact.normalImpulse / mass[a];
+
+            if (dynamicB)
+            {
+                speedX[b] -= contact.normalX * contact.normalImpulse / mass[b];
+                speedY[b] -= contact.normalY * contact.normalImpulse / mass[b];
+            }
+
+            this->warmStartedContacts++;
+        }
+    }
+
+    Scalar correctionSpeed = Scalar(SPLIT_IMPULSE_FACTOR) / deltaTime;
+
+    for (int iteration = 0; iteration < iterations; iteration++)
+    {
+        for (int c = 0; c < numContacts; c++)
+        {
+            ImpulseContact<Scalar>& contact = this->contacts[c];
+
+            int a = contact.a;
+            int b = contact.b;
+
+            bool dynamicB = b >= 0 && b < numDynamicBodies;
+
+            // Velocity: the contact may push but never pull, so only the accumulated impulse is clamped.
+            Scalar normalSpeed = speedX[a] * contact.normalX + speedY[a] * contact.normalY;
+
+            if (dynamicB)
+                normalSpeed -= speedX[b] * contact.normalX + speedY[b] * contact.normalY;
+
+            normalSpeed -= contact.surfaceSpeed;
+
+            Scalar impulse = contact.effectiveMass * -normalSpeed;
+            Scalar accumulated = max(contact.normalImpulse + impulse, Scalar(0));
+
+            impulse = accumulated - contact.normalImpulse;
+            contact.normalImpulse = accumulated;
+
+            speedX[a] += contact.normalX * impulse / mass[a];
+            speedY[a] += contact.normalY * impulse / mass[a];
+
+            if (dynamicB)
+            {
+                speedX[b] -= contact.normalX * impulse / mass[b];
+                speedY[b] -= contact.normalY * impulse / mass[b];
+            }
+
+            // Position, through the pseudo-velocities.
+            Scalar biasSpeed = biasSpeedX[a] * contact.normalX + biasSpeedY[a] * contact.normalY;
+
+            if (dynamicB)
+                biasSpeed -= biasSpeedX[b] * contact.normalX + biasSpeedY[b] * contact.normalY;
+
+            Scalar biasTarget = correctionSpeed * max(-contact.separation - Scalar(CONTACT_SLOP), Scalar(0));
+
+            Scalar positionImpulse = contact.effectiveMass * (biasTarget - biasSpeed);
+            Scalar positionAccumulated = max(contact.positionImpulse + positionImpulse, Scalar(0));
+
+            positionImpulse = positionAccumulated - contact.positionImpulse;
+            contact.positionImpulse = positionAccumulated;
+
+            biasSpeedX[a] += contact.normalX * positionImpulse / mass[a];
+            biasSpeedY[a] += contact.normalY * positionImpulse / mass[a];
+
+            if (dynamicB)
+            {
+                biasSpeedX[b] -= contact.normalX * positionImpulse / mass[b];
+                biasSpeedY[b] -= contact.normalY * positionImpulse / mass[b];
+            }
+        }
+    }
+
+    // Restitution last, once the iterations have settled the resting contacts, so a bounce is not spread through a
+    // stack as extra push.
+    for (int c = 0; c < numContacts; c++)
+    {
+        ImpulseContact<Scalar>& contact = this->contacts[c];
+
+        if (contact.velocityTarget <= 0)
+            continue;
+
+        int a = contact.a;
+        int b = contact.b;
+
+        bool dynamicB = b >= 0 && b < numDynamicBodies;
+
+        Scalar normalSpeed = speedX[a] * contact.normalX + speedY[a] * contact.normalY;
+
+        if (dynamicB)
+            normalSpeed -= speedX[b] * contact.normalX + speedY[b] * contact.normalY;
+
+        normalSpeed -= contact.surfaceSpeed;
+
+        Scalar impulse = contact.effectiveMass * (contact.velocityTarget - normalSpeed);
+        Scalar accumulated = max(contact.normalImpulse + impulse, Scalar(0));
+
+        impulse = accumulated - contact.normalImpulse;
+        contact.normalImpulse = accumulated;
+
+        speedX[a] += contact.normalX * impulse / mass[a];
+        speedY[a] += contact.normalY * impulse / mass[a];
+
+        if (dynamicB)
+        {
+            speedX[b] -= contact.normalX * impulse / mass[b];
+            speedY[b] -= contact.normalY * impulse / mass[b];
+        }
+    }
+
+    for (int i = 0; i < numDynamicBodies; i++)
+    {
+        posX[i] += biasSpeedX[i] * deltaTime;
+        posY[i] += biasSpeedY[i] * deltaTime;
+    }
+}
+
+template struct ImpulseSolver<float>;
+template struct ImpulseSolver<double>;
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <vector>
+
+// Default number of velocity iterations per substep; World::contactIterations can be changed at any time.
+const int CONTACT_ITERATIONS = 8;
+
+// Contacts closing slower than this, in world units per second, get no restitution, so resting contacts stay at rest.
+const double RESTITUTION_THRESHOLD = 60.0;
+
+// Overlap, in world units, left uncorrected so resting contacts persist from one substep to the next.
+const double CONTACT_SLOP = 0.5;
+
+// Fraction of the remaining overlap the split impulses remove per substep.
+const double SPLIT_IMPULSE_FACTOR = 0.2;
+
+// One circle-versus-something contact for a substep. a is an awake circle; b is another circle, sleeping ones
+// included, or -1 for walls and capsules. key tells b apart from the other bodies a may touch, and increases with
+// the order the owner adds a's contacts in, which is how contacts are matched with the previous substep's.
+template <typename Scalar>
+struct ImpulseContact
+{
+    int a;
+    int b;
+    int key;
+
+    // From b to a.
+    Scalar normalX;
+    Scalar normalY;
+
+    // Negative while the bodies overlap.
+    Scalar separation;
+
+    // Normal speed of b's surface when b is a moving capsule, 0 otherwise; normal speeds are taken relative to it.
+    Scalar surfaceSpeed;
+
+    Scalar restitution;
+
+    Scalar effectiveMass;
+    Scalar velocityTarget;
+
+    // Accumulated over the iterations; normalImpulse also warm starts the next substep.
+    Scalar normalImpulse;
+    Scalar positionImpulse;
+};
+
+// Sequential impulses over persistent contacts. Every substep the owner adds the contacts in (a, key) order and calls
+// solve: contacts found in the previous substep too start from the impulse they ended with (warm starting), the
+// velocity iterations then only make up the difference, and split impulses push overlapping bodies apart through
+// separate pseudo-velocities, so the correction adds no energy. Restitution is applied in one pass after the
+// iterations. Velocities are left for the integrator; the position correction is applied here.
+template <typename Scalar>
+struct ImpulseSolver
+{
+    std::vector<ImpulseContact<Scalar>> contacts;
+    std::vector<ImpulseContact<Scalar>> previousContacts;
+
+    // Pseudo-velocities of the split impulses.
+    std::vector<Scalar> biasSpeedX;
+    std::vector<Scalar> biasSpeedY;
+
+    // The owner's bodiesVersion when previousContacts were made; any other value means indices changed meaning.
+    int bodiesVersion = -1;
+
+    // Statistics of the last solve.
+    int warmStartedContacts = 0;
+    Scalar maxPenetration = 0;
+
+    // Moves the last substep's contacts aside to be matched against.
+    void beginContacts(int bodiesVersion);
+
+    void addContact(int a, int b, int key, Scalar normalX, Scalar normalY, Scalar separation, Scalar surfaceSpeed, Scalar restitution);
+
+    // Bodies numDynamicBodies and above are static, like b == -1.
+    void solve(Scalar* posX, Scalar* posY, Scalar* speedX, Scalar* speedY, const Scalar* mass, int numDynamicBodies, Scalar deltaTime, int iterations);
+};
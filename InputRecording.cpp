@@ -0,0 +1,182 @@
+#include "InputRecording.h"
+
+#include <fstream>
+
+using namespace std;
+
+const int NUM_INPUT_KEYS = 12;
+
+bool getInputKey(const InputState& state, int key)
+{
+    const bool keys[NUM_INPUT_KEYS] = { state.keyUp, state.keyDown, state.keyLeft, state.keyRight, state.keyB, state.keyG, state.keyW, state.keyA, state.keyS, state.keyD, state.keyQ, state.keyE };
+
+    return keys[key];
+}
+
+void setInputKey(InputState& state, int key, bool pressed)
+{
+    bool* keys[NUM_INPUT_KEYS] = { &state.keyUp, &state.keyDown, &state.keyLeft, &state.keyRight, &state.keyB, &state.keyG, &state.keyW, &state.keyA, &state.keyS, &state.keyD, &state.keyQ, &state.keyE };
+
+    *keys[key] = pressed;
+}
+
+bool sameInputState(const InputState& first, const InputState& second)
+{
+    for (int key = 0; key < NUM_INPUT_KEYS; key++)
+    {
+        if (getInputKey(first, key) != getInputKey(second, key))
+            return false;
+    }
+
+    return true;
+}
+
+bool InputRecording::save(const string& path) const
+{
+    ofstream file(path);
+
+    if (!file)
+        return false;
+
+    file.precision(17);
+
+    file << "input 1\n";
+    file << "circles " << this->numCircles << " capsules " << this->numCapsules << " substeps " << this->numberOfSimulations << " seed " << this->seed << "\n";
+
+    int nextEvent = 0;
+
+    for (int frame = 0; frame < this->frameDeltaTimes.size(); frame++)
+    {
+        file << "frame " << frame << " " << this->frameDeltaTimes[frame] << "\n";
+
+        while (nextEvent < this->events.size() && this->events[nextEvent].frame == frame)
+        {
+            const InputEvent& event = this->events[nextEvent];
+
+            file << "event " << event.frame << " " << event.substep << " ";
+
+            for (int key = 0; key < NUM_INPUT_KEYS; key++)
+                file << (getInputKey(event.state, key) ? '1' : '0');
+
+            file << "\n";
+
+            nextEvent++;
+        }
+    }
+
+    return (bool)file;
+}
+
+bool InputRecording::load(const string& path)
+{
+    ifstream file(path);
+
+    if (!file)
+        return false;
+
+    string magic;
+    int version;
+
+    file >> magic >> version;
+
+    if (magic != "input" || version != 1)
+        return false;
+
+    string key;
+
+    file >> key >> this->numCircles >> key >> this->numCapsules >> key >> this->numberOfSimulations >> key >> this->seed;
+
+    if (!file)
+        return false;
+
+    this->frameDeltaTimes.clear();
+    this->events.clear();
+
+    string kind;
+
+    while (file >> kind)
+    {
+        if (kind == "frame")
+        {
+            int frame;
+            double deltaTime;
+
+            file >> frame >> deltaTime;
+
+            if (!file || frame != this->frameDeltaTimes.size())
+                return false;
+
+            this->frameDeltaTimes.push_back(deltaTime);
+        }
+        else if (kind == "event")
+        {
+            InputEvent event;
+            string keys;
+
+            file >> event.frame >> event.substep >> keys;
+
+            if (!file || keys.size() != NUM_INPUT_KEYS)
+                return false;
+
+            for (int key = 0; key < NUM_INPUT_KEYS; key++)
+                setInputKey(event.state, key, keys[key] == '1');
+
+            this->events.push_back(event);
+        }
+        else
+            return false;
+    }
+
+    return true;
+}
+
+void InputRecorder::recordFrame(int frame, double deltaTime)
+{
+    this->recording.frameDeltaTimes.resize(frame + 1);
+    this->recording.frameDeltaTimes[frame] = deltaTime;
+}
+
+void InputRecorder::recordSubstep(int frame, int substep, const InputState& state)
+{
+    if (this->hasLastState && sameInputState(state, this->lastState))
+        return;
+
+    InputEvent event;
+
+    event.frame = frame;
+    event.substep = substep;
+    event.state = state;
+
+    this->recording.events.push_back(event);
+
+    this->lastState = state;
+    this->hasLastState = true;
+}
+
+InputPlayer::InputPlayer(const InputRecording* recording)
+{
+    this->recording = recording;
+}
+
+int InputPlayer::frames() const
+{
+    return this->recording->frameDeltaTimes.size();
+}
+
+double InputPlayer::frameDeltaTime(int frame) const
+{
+    return this->recording->frameDeltaTimes[frame];
+}
+
+const InputState& InputPlayer::stateAt(int frame, int substep)
+{
+    const vector<InputEvent>& events = this->recording->events;
+
+    while (this->nextEvent < events.size() && (events[this->nextEvent].frame < frame || (events[this->nextEvent].frame == frame && events[this->nextEvent].substep <= substep)))
+    {
+        this->currentState = events[this->nextEvent].state;
+        this->nextEvent++;
+    }
+
+    return this->currentState;
+}
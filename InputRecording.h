@@ -0,0 +1,57 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "World.h"
+
+// Captured keyboard stream: every frame's delta time plus each change of InputState, stamped with the frame and
+// substep where it first applies. Replaying it reproduces the same explosions, gravity switches and capsule moves.
+
+struct InputEvent
+{
+    int frame;
+    int substep;
+
+    InputState state;
+};
+
+struct InputRecording
+{
+    int numCircles = 0;
+    int numCapsules = 0;
+    int numberOfSimulations = NUMBER_OF_SIMULATIONS;
+    unsigned int seed = 0;
+
+    std::vector<double> frameDeltaTimes;
+    std::vector<InputEvent> events;
+
+    bool save(const std::string& path) const;
+    bool load(const std::string& path);
+};
+
+struct InputRecorder
+{
+    InputRecording recording;
+
+    InputState lastState;
+    bool hasLastState = false;
+
+    void recordFrame(int frame, double deltaTime);
+    void recordSubstep(int frame, int substep, const InputState& state);
+};
+
+struct InputPlayer
+{
+    const InputRecording* recording = nullptr;
+
+    int nextEvent = 0;
+    InputState currentState;
+
+    InputPlayer(const InputRecording* recording);
+
+    int frames() const;
+    double frameDeltaTime(int frame) const;
+
+    const InputState& stateAt(int frame, int substep);
+};
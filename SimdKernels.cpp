@@ -0,0 +1,510 @@
+#include "SimdKernels.h"
+
+#include <cmath>
+
+#if !defined(PHYSICS_NO_SIMD) && defined(__AVX__)
+#define PHYSICS_SIMD_AVX
+#include <immintrin.h>
+#elif !defined(PHYSICS_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define PHYSICS_SIMD_SSE2
+#include <emmintrin.h>
+#endif
+
+using namespace std;
+
+#if defined(PHYSICS_SIMD_AVX) || defined(PHYSICS_SIMD_SSE2)
+
+// The few operations the kernels need, so each kernel is written once for both scalars and both instruction sets.
+// Comparisons return a mask vector, which select blends with and bits turns into one bit per lane, lane 0 in bit 0.
+template <typename Scalar>
+struct SimdBatch;
+
+#ifdef PHYSICS_SIMD_AVX
+
+template <>
+struct SimdBatch<double>
+{
+    typedef __m256d Vector;
+
+    static const int LANES = 4;
+
+    static Vector load(const double* values)
+    {
+        return _mm256_loadu_pd(values);
+    }
+
+    static void store(double* values, Vector value)
+    {
+        _mm256_storeu_pd(values, value);
+    }
+
+    static Vector broadcast(double value)
+    {
+        return _mm256_set1_pd(value);
+    }
+
+    static Vector add(Vector a, Vector b)
+    {
+        return _mm256_add_pd(a, b);
+    }
+
+    static Vector sub(Vector a, Vector b)
+    {
+        return _mm256_sub_pd(a, b);
+    }
+
+    static Vector mul(Vector a, Vector b)
+    {
+        return _mm256_mul_pd(a, b);
+    }
+
+    static Vector div(Vector a, Vector b)
+    {
+        return _mm256_div_pd(a, b);
+    }
+
+    static Vector sqrt(Vector a)
+    {
+        return _mm256_sqrt_pd(a);
+    }
+
+    static Vector lessThan(Vector a, Vector b)
+    {
+        return _mm256_cmp_pd(a, b, _CMP_LT_OQ);
+    }
+
+    static Vector greaterThan(Vector a, Vector b)
+    {
+        return _mm256_cmp_pd(a, b, _CMP_GT_OQ);
+    }
+
+    static Vector select(Vector mask, Vector ifTrue, Vector ifFalse)
+    {
+        return _mm256_blendv_pd(ifFalse, ifTrue, mask);
+    }
+
+    static int bits(Vector mask)
+    {
+        return _mm256_movemask_pd(mask);
+    }
+};
+
+template <>
+struct SimdBatch<float>
+{
+    typedef __m256 Vector;
+
+    static const int LANES = 8;
+
+    static Vector load(const float* values)
+    {
+        return _mm256_loadu_ps(values);
+    }
+
+    static void store(float* values, Vector value)
+    {
+        _mm256_storeu_ps(values, value);
+    }
+
+    static Vector broadcast(float value)
+    {
+        return _mm256_set1_ps(value);
+    }
+
+    static Vector add(Vector a, Vector b)
+    {
+        return _mm256_add_ps(a, b);
+    }
+
+    static Vector sub(Vector a, Vector b)
+    {
+        return _mm256_sub_ps(a, b);
+    }
+
+    static Vector mul(Vector a, Vector b)
+    {
+        return _mm256_mul_ps(a, b);
+    }
+
+    static Vector div(Vector a, Vector b)
+    {
+        return _mm256_div_ps(a, b);
+    }
+
+    static Vector sqrt(Vector a)
+    {
+        return _mm256_sqrt_ps(a);
+    }
+
+    static Vector lessThan(Vector a, Vector b)
+    {
+        return _mm256_cmp_ps(a, b, _CMP_LT_OQ);
+    }
+
+    static Vector greaterThan(Vector a, Vector b)
+    {
+        return _mm256_cmp_ps(a, b, _CMP_GT_OQ);
+    }
+
+    static Vector select(Vector mask, Vector ifTrue, Vector ifFalse)
+    {
+        return _mm256_blendv_ps(ifFalse, ifTrue, mask);
+    }
+
+    static int bits(Vector mask)
+    {
+        return _mm256_movemask_ps(mask);
+    }
+};
+
+#else
+
+template <>
+struct SimdBatch<double>
+{
+    typedef __m128d Vector;
+
+    static const int LANES = 2;
+
+    static Vector load(const double* values)
+    {
+        return _mm_loadu_pd(values);
+    }
+
+    static void store(double* values, Vector value)
+    {
+        _mm_storeu_pd(values, value);
+    }
+
+    static Vector broadcast(double value)
+    {
+        return _mm_set1_pd(value);
+    }
+
+    static Vector add(Vector a, Vector b)
+    {
+        return _mm_add_pd(a, b);
+    }
+
+    static Vector sub(Vector a, Vector b)
+    {
+        return _mm_sub_pd(a, b);
+    }
+
+    static Vector mul(Vector a, Vector b)
+    {
+        return _mm_mul_pd(a, b);
+    }
+
+    static Vector div(Vector a, Vector b)
+    {
+        return _mm_div_pd(a, b);
+    }
+
+    static Vector sqrt(Vector a)
+    {
+        return _mm_sqrt_pd(a);
+    }
+
+    static Vector lessThan(Vector a, Vector b)
+    {
+        return _mm_cmplt_pd(a, b);
+    }
+
+    static Vector greaterThan(Vector a, Vector b)
+    {
+        return _mm_cmpgt_pd(a, b);
+    }
+
+    static Vector select(Vector mask, Vector ifTrue, Vector ifFalse)
+    {
+        return _mm_or_pd(_mm_and_pd(mask, ifTrue), _mm_andnot_pd(mask, ifFalse));
+    }
+
+    static int bits(Vector mask)
+    {
+        return _mm_movemask_pd(mask);
+    }
+};
+
+template <>
+struct SimdBatch<float>
+{
+    typedef __m128 Vector;
+
+    static const int LANES = 4;
+
+    static Vector load(const float* values)
+    {
+        return _mm_loadu_ps(values);
+    }
+
+    static void store(float* values, Vector value)
+    {
+        _mm_storeu_ps(values, value);
+    }
+
+    static Vector broadcast(float value)
+    {
+        return _mm_set1_ps(value);
+    }
+
+    static Vector add(Vector a, Vector b)
+    {
+        return _mm_add_ps(a, b);
+    }
+
+    static Vector sub(Vector a, Vector b)
+    {
+        return _mm_sub_ps(a, b);
+    }
+
+    static Vector mul(Vector a, Vector b)
+    {
+        return _mm_mul_ps(a, b);
+    }
+
+    static Vector div(Vector a, Vector b)
+    {
+        return _mm_div_ps(a, b);
+    }
+
+    static Vector sqrt(Vector a)
+    {
+        return _mm_sqrt_ps(a);
+    }
+
+    static Vector lessThan(Vector a, Vector b)
+    {
+        return _mm_cmplt_ps(a, b);
+    }
+
+    static Vector greaterThan(Vector a, Vector b)
+    {
+        return _mm_cmpgt_ps(a, b);
+    }
+
+    static Vector select(Vector mask, Vector ifTrue, Vector ifFalse)
+    {
+        return _mm_or_ps(_mm_and_ps(mask, ifTrue), _mm_andnot_ps(mask, ifFalse));
+    }
+
+    static int bits(Vector mask)
+    {
+        return _mm_movemask_ps(mask);
+    }
+};
+
+#endif
+
+inline int lowestSetBit(int mask)
+{
+    int bit = 0;
+
+    while ((mask & (1 << bit)) == 0)
+        bit++;
+
+    return bit;
+}
+
+#endif
+
+template <typename Scalar>
+int findFirstCircleOverlap(Scalar posXI, Scalar posYI, Scalar radiusI, const Scalar* posX, const Scalar* posY, const Scalar* radius, int begin, int end)
+{
+    int j = begin;
+
+#if defined(PHYSICS_SIMD_AVX) || defined(PHYSICS_SIMD_SSE2)
+    typedef SimdBatch<Scalar> Batch;
+    typedef typename Batch::Vector Vector;
+
+    Vector posXIs = Batch::broadcast(posXI);
+    Vector posYIs = Batch::broadcast(posYI);
+    Vector radiusIs = Batch::broadcast(radiusI);
+
+    // Most rows hit nothing, so whole batches are skipped on one mask test; a hit is reported at its exact lane and
+    // the caller resumes after it, since resolving it moves circle i.
+    for (; j + Batch::LANES <= end; j += Batch::LANES)
+    {
+        Vector deltaX = Batch::sub(posXIs, Batch::load(posX + j));
+        Vector deltaY = Batch::sub(posYIs, Batch::load(posY + j));
+
+        Vector radii = Batch::add(radiusIs, Batch::load(radius + j));
+
+        int hits = Batch::bits(Batch::lessThan(Batch::add(Batch::mul(deltaX, deltaX), Batch::mul(deltaY, deltaY)), Batch::mul(radii, radii)));
+
+        if (hits != 0)
+            return j + lowestSetBit(hits);
+    }
+#endif
+
+    for (; j < end; j++)
+    {
+        Scalar deltaX = posXI - posX[j];
+        Scalar deltaY = posYI - posY[j];
+
+        if (deltaX * deltaX + deltaY * deltaY < (radiusI + radius[j]) * (radiusI + radius[j]))
+            return j;
+    }
+
+    return end;
+}
+
+template <typename Scalar>
+void collideCirclesCapsule(Scalar* posX, Scalar* posY, Scalar* speedX, Scalar* speedY, const Scalar* radius, int begin, int end,
+    Scalar endX, Scalar endY, Scalar axisX, Scalar axisY, Scalar length, Scalar capsuleRadius,
+    Scalar capsuleSpeedX, Scalar capsuleSpeedY, Scalar capsuleAngularSpeed, Scalar damping)
+{
+    int i = begin;
+
+#if defined(PHYSICS_SIMD_AVX) || defined(PHYSICS_SIMD_SSE2)
+    typedef SimdBatch<Scalar> Batch;
+    typedef typename Batch::Vector Vector;
+
+    Vector endXs = Batch::broadcast(endX);
+    Vector endYs = Batch::broadcast(endY);
+    Vector axisXs = Batch::broadcast(axisX);
+    Vector axisYs = Batch::broadcast(axisY);
+    Vector lengths = Batch::broadcast(length);
+    Vector capsuleRadii = Batch::broadcast(capsuleRadius);
+    Vector halfLengths = Batch::broadcast(length / 2);
+    Vector capsuleSpeedXs = Batch::broadcast(capsuleSpeedX);
+    Vector capsuleSpeedYs = Batch::broadcast(capsuleSpeedY);
+    Vector capsuleAngularSpeeds = Batch::broadcast(capsuleAngularSpeed);
+    Vector dampings = Batch::broadcast(damping);
+    Vector zeros = Batch::broadcast(Scalar(0));
+
+    for (; i + Batch::LANES <= end; i += Batch::LANES)
+    {
+        Vector circleX = Batch::load(posX + i);
+        Vector circleY = Batch::load(posY + i);
+
+        Vector deltaX = Batch::sub(circleX, endXs);
+        Vector deltaY = Batch::sub(circleY, endYs);
+
+        Vector projection = Batch::add(Batch::mul(deltaX, axisXs), Batch::mul(deltaY, axisYs));
+
+        projection = Batch::select(Batch::lessThan(projection, zeros), zeros, Batch::select(Batch::greaterThan(projection, lengths), lengths, projection));
+
+        Vector toNearX = Batch::sub(Batch::add(endXs, Batch::mul(axisXs, projection)), circleX);
+        Vector toNearY = Batch::sub(Batch::add(endYs, Batch::mul(axisYs, projection)), circleY);
+
+        Vector distSquared = Batch::add(Batch::mul(toNearX, toNearX), Batch::mul(toNearY, toNearY));
+
+        Vector radii = Batch::add(Batch::load(radius + i), capsuleRadii);
+
+        Vector hits = Batch::lessThan(distSquared, Batch::mul(radii, radii));
+
+        if (Batch::bits(hits) == 0)
+            continue;
+
+        // Every lane computes the response; only the lanes that hit keep it.
+        Vector dist = Batch::sqrt(distSquared);
+
+        Vector normalX = Batch::div(toNearX, dist);
+        Vector normalY = Batch::div(toNearY, dist);
+
+        Vector overlap = Batch::sub(radii, dist);
+
+        Batch::store(posX + i, Batch::select(hits, Batch::sub(circleX, Batch::mul(normalX, overlap)), circleX));
+        Batch::store(posY + i, Batch::select(hits, Batch::sub(circleY, Batch::mul(normalY, overlap)), circleY));
+
+        Vector circleSpeedX = Batch::load(speedX + i);
+        Vector circleSpeedY = Batch::load(speedY + i);
+
+        // Speed of the surface at the nearest point: the rotation adds its part across the axis.
+        Vector rotation = Batch::mul(capsuleAngularSpeeds, Batch::sub(projection, halfLengths));
+
+        Vector surfaceSpeedX = Batch::sub(capsuleSpeedXs, Batch::mul(rotation, axisYs));
+        Vector surfaceSpeedY = Batch::add(capsuleSpeedYs, Batch::mul(rotation, axisXs));
+
+        Vector speedProjection = Batch::sub(Batch::add(Batch::mul(circleSpeedX, normalX), Batch::mul(circleSpeedY, normalY)),
+            Batch::add(Batch::mul(surfaceSpeedX, normalX), Batch::mul(surfaceSpeedY, normalY)));
+
+        Vector newSpeedX = Batch::sub(circleSpeedX, Batch::mul(normalX, speedProjection));
+        Vector newSpeedY = Batch::sub(circleSpeedY, Batch::mul(normalY, speedProjection));
+
+        newSpeedX = Batch::sub(newSpeedX, Batch::mul(Batch::mul(dampings, normalX), speedProjection));
+        newSpeedY = Batch::sub(newSpeedY, Batch::mul(Batch::mul(dampings, normalY), speedProjection));
+
+        Batch::store(speedX + i, Batch::select(hits, newSpeedX, circleSpeedX));
+        Batch::store(speedY + i, Batch::select(hits, newSpeedY, circleSpeedY));
+    }
+#endif
+
+    for (; i < end; i++)
+    {
+        Scalar deltaX = posX[i] - endX;
+        Scalar deltaY = posY[i] - endY;
+
+        Scalar projection = deltaX * axisX + deltaY * axisY;
+
+        if (projection < 0)
+            projection = 0;
+        else if (projection > length)
+            projection = length;
+
+        Scalar toNearX = endX + axisX * projection - posX[i];
+        Scalar toNearY = endY + axisY * projection - posY[i];
+
+        if (toNearX * toNearX + toNearY * toNearY < (radius[i] + capsuleRadius) * (radius[i] + capsuleRadius))
+        {
+            Scalar dist = sqrt(toNearX * toNearX + toNearY * toNearY);
+
+            Scalar normalX = toNearX / dist;
+            Scalar normalY = toNearY / dist;
+
+            Scalar overlap = radius[i] + capsuleRadius - dist;
+
+            posX[i] -= normalX * overlap;
+            posY[i] -= normalY * overlap;
+
+            Scalar rotation = capsuleAngularSpeed * (projection - length / 2);
+
+            Scalar surfaceSpeedX = capsuleSpeedX - rotation * axisY;
+            Scalar surfaceSpeedY = capsuleSpeedY + rotation * axisX;
+
+            Scalar speedProjection = speedX[i] * normalX + speedY[i] * normalY - (surfaceSpeedX * normalX + surfaceSpeedY * normalY);
+
+            speedX[i] -= normalX * speedProjection;
+            speedY[i] -= normalY * speedProjection;
+
+            speedX[i] -= damping * normalX * speedProjection;
+            speedY[i] -= damping * normalY * speedProjection;
+        }
+    }
+}
+
+template <typename Scalar>
+int simdLanes()
+{
+#if defined(PHYSICS_SIMD_AVX) || defined(PHYSICS_SIMD_SSE2)
+    return SimdBatch<Scalar>::LANES;
+#else
+    return 1;
+#endif
+}
+
+const char* simdInstructionSet()
+{
+#if defined(PHYSICS_SIMD_AVX)
+    return "avx";
+#elif defined(PHYSICS_SIMD_SSE2)
+    return "sse2";
+#else
+    return "scalar";
+#endif
+}
+
+template int findFirstCircleOverlap(float posXI, float posYI, float radiusI, const float* posX, const float* posY, const float* radius, int begin, int end);
+template int findFirstCircleOverlap(double posXI, double posYI, double radiusI, const double* posX, const double* posY, const double* radius, int begin, int end);
+
+template void collideCirclesCapsule(float* posX, float* posY, float* speedX, float* speedY, const float* radius, int begin, int end,
+    float endX, float endY, float axisX, float axisY, float length, float capsuleRadius,
+    float capsuleSpeedX, float capsuleSpeedY, float capsuleAngularSpeed, float damping);
+template void collideCirclesCapsule(double* posX, double* posY, double* speedX, double* speedY, const double* radius, int begin, int end,
+    double endX, double endY, double axisX, double axisY, double length, double capsuleRadius,
+    double capsuleSpeedX, double capsuleSpeedY, double capsuleAngularSpeed, double damping);
+
+template int simdLanes<float>();
+template int simdLanes<double>();
@@ -0,0 +1,27 @@
+#pragma once
+
+// Vectorized pieces of the collision passes. They use AVX when the build enables it (/arch:AVX2 or -mavx2), SSE2
+// otherwise on x86 and x64, and scalar code elsewhere or when PHYSICS_NO_SIMD is defined. Every lane does exactly the
+// arithmetic of the scalar code in World.cpp, so the instruction set never changes a trajectory.
+
+// Index of the first circle j in [begin, end) that overlaps the circle at (posXI, posYI) with radius radiusI, or end.
+// The test is the one collideCircles starts with.
+template <typename Scalar>
+int findFirstCircleOverlap(Scalar posXI, Scalar posYI, Scalar radiusI, const Scalar* posX, const Scalar* posY, const Scalar* radius, int begin, int end);
+
+// Resolves circles begin .. end - 1 against one capsule: a circle overlapping it is pushed out along the normal and
+// the normal part of its speed relative to the capsule's surface is reflected, scaled by damping. The capsule is its
+// endpoint 1 (endX, endY), the unit axis towards endpoint 0, the distance between the endpoints and its radius, as
+// cached by BasicCapsule, and its kinematic velocity about the middle. Circles are independent of each other here, so
+// a whole vector of them is tested and resolved at once.
+template <typename Scalar>
+void collideCirclesCapsule(Scalar* posX, Scalar* posY, Scalar* speedX, Scalar* speedY, const Scalar* radius, int begin, int end,
+    Scalar endX, Scalar endY, Scalar axisX, Scalar axisY, Scalar length, Scalar capsuleRadius,
+    Scalar capsuleSpeedX, Scalar capsuleSpeedY, Scalar capsuleAngularSpeed, Scalar damping);
+
+// How many circles one vector test covers for Scalar in this build, 1 without SIMD.
+template <typename Scalar>
+int simdLanes();
+
+// "avx", "sse2" or "scalar".
+const char* simdInstructionSet();
@@ -0,0 +1,198 @@
+#include "SweepAndPrune.h"
+#include "World.h"
+
+#include <algorithm>
+
+using namespace std;
+
+// Lower endpoints go first on ties, so touching intervals count as overlapping, like in overlaps().
+template <typename Scalar>
+bool endpointLess(const typename SweepAndPrune<Scalar>::Endpoint& first, const typename SweepAndPrune<Scalar>::Endpoint& second)
+{
+    return first.value < second.value || (first.value == second.value && !first.isUpper && second.isUpper);
+}
+
+template <typename Scalar>
+void SweepAndPrune<Scalar>::update(const Scalar* posX, const Scalar* posY, const Scalar* radius, int numCircles, const BasicCapsule<Scalar>* capsules, int numCapsules, Scalar margin, int bodiesVersion)
+{
+    bool bodiesChanged = bodiesVersion != this->bodiesVersion || numCircles != this->numCircles || numCapsules != this->numCapsules;
+
+    this->bodiesVersion = bodiesVersion;
+
+    this->numCircles = numCircles;
+    this->numCapsules = numCapsules;
+
+    int numIds = numCircles + numCapsules;
+
+    this->lowerX.resize(numIds);
+    this->upperX.resize(numIds);
+    this->lowerY.resize(numIds);
+    this->upperY.resize(numIds);
+
+    for (int i = 0; i < numCircles; i++)
+    {
+        Scalar extent = radius[i] * (1 + margin);
+
+        this->lowerX[i] = posX[i] - extent;
+        this->upperX[i] = posX[i] + extent;
+        this->lowerY[i] = posY[i] - extent;
+        this->upperY[i] = posY[i] + extent;
+    }
+
+    for (int j = 0; j < numCapsules; j++)
+    {
+        Scalar extent = capsules[j].radius * (1 + margin);
+
+        this->lowerX[numCircles + j] = min(capsules[j].posX[0], capsules[j].posX[1]) - extent;
+        this->upperX[numCircles + j] = max(capsules[j].posX[0], capsules[j].posX[1]) + extent;
+        this->lowerY[numCircles + j] = min(capsules[j].posY[0], capsules[j].posY[1]) - extent;
+        this->upperY[numCircles + j] = max(capsules[j].posY[0], capsules[j].posY[1]) + extent;
+    }
+
+    if (bodiesChanged)
+    {
+        this->rebuild();
+        return;
+    }
+
+    this->sortAxis(this->endpointsX, this->lowerX, this->upperX);
+    this->sortAxis(this->endpointsY, this->lowerY, this->upperY);
+}
+
+template <typename Scalar>
+void SweepAndPrune<Scalar>::sortAxis(vector<Endpoint>& endpoints, const vector<Scalar>& lower, const vector<Scalar>& upper)
+{
+    for (int k = 0; k < endpoints.size(); k++)
+        endpoints[k].value = endpoints[k].isUpper ? upper[endpoints[k].id] : lower[endpoints[k].id];
+
+    // Insertion sort. Each inversion is fixed by exactly one swap and only a lower/upper swap can change whether two
+    // boxes overlap. overlaps() reads the new boxes on both axes, so settling the pair there keeps partners exact
+    // even while the other axis is still out of order.
+    for (int k = 1; k < endpoints.size(); k++)
+    {
+        Endpoint endpoint = endpoints[k];
+
+        int m = k;
+
+        while (m > 0 && endpointLess<Scalar>(endpoint, endpoints[m - 1]))
+        {
+            const Endpoint& other = endpoints[m - 1];
+
+            if (endpoint.isUpper != other.isUpper && endpoint.id != other.id)
+            {
+                if (this->overlaps(endpoint.id, other.id))
+                    this->addPair(endpoint.id, other.id);
+                else
+                    this->removePair(endpoint.id, other.id);
+            }
+
+            endpoints[m] = other;
+            m--;
+
+            this->swaps++;
+        }
+
+        endpoints[m] = endpoint;
+    }
+}
+
+template <typename Scalar>
+void SweepAndPrune<Scalar>::rebuild()
+{
+    int numIds = this->numCircles + this->numCapsules;
+
+    this->rebuilds++;
+
+    this->endpointsX.resize(2 * numIds);
+    this->endpointsY.resize(2 * numIds);
+
+    for (int id = 0; id < numIds; id++)
+    {
+        this->endpointsX[2 * id] = { this->lowerX[id], id, false };
+        this->endpointsX[2 * id + 1] = { this->upperX[id], id, true };
+
+        this->endpointsY[2 * id] = { this->lowerY[id], id, false };
+        this->endpointsY[2 * id + 1] = { this->upperY[id], id, true };
+    }
+
+    sort(this->endpointsX.begin(), this->endpointsX.end(), endpointLess<Scalar>);
+    sort(this->endpointsY.begin(), this->endpointsY.end(), endpointLess<Scalar>);
+
+    this->partners.resize(numIds);
+
+    for (int id = 0; id < numIds; id++)
+        this->partners[id].clear();
+
+    // One sweep along x: every interval opened while another is still open overlaps it on x.
+    vector<int> openIds;
+    vector<int> openPosition(numIds, -1);
+
+    for (int k = 0; k < this->endpointsX.size(); k++)
+    {
+        int id = this->endpointsX[k].id;
+
+        if (this->endpointsX[k].isUpper)
+        {
+            int position = openPosition[id];
+
+            openIds[position] = openIds.back();
+            openPosition[openIds[position]] = position;
+            openIds.pop_back();
+        }
+        else
+        {
+            for (int l = 0; l < openIds.size(); l++)
+            {
+                if (this->overlaps(id, openIds[l]))
+                    this->addPair(id, openIds[l]);
+            }
+
+            openPosition[id] = (int)openIds.size();
+            openIds.push_back(id);
+        }
+    }
+}
+
+template <typename Scalar>
+bool SweepAndPrune<Scalar>::overlaps(int first, int second) const
+{
+    return this->lowerX[first] <= this->upperX[second] && this->lowerX[second] <= this->upperX[first]
+        && this->lowerY[first] <= this->upperY[second] && this->lowerY[second] <= this->upperY[first];
+}
+
+template <typename Scalar>
+void SweepAndPrune<Scalar>::addPair(int first, int second)
+{
+    int low = min(first, second);
+    int high = max(first, second);
+
+    if (low >= this->numCircles)
+        return;
+
+    vector<int>& list = this->partners[low];
+
+    vector<int>::iterator position = lower_bound(list.begin(), list.end(), high);
+
+    if (position == list.end() || *position != high)
+        list.insert(position, high);
+}
+
+template <typename Scalar>
+void SweepAndPrune<Scalar>::removePair(int first, int second)
+{
+    int low = min(first, second);
+    int high = max(first, second);
+
+    if (low >= this->numCircles)
+        return;
+
+    vector<int>& list = this->partners[low];
+
+    vector<int>::iterator position = lower_bound(list.begin(), list.end(), high);
+
+    if (position != list.end() && *position == high)
+        list.erase(position);
+}
+
+template struct SweepAndPrune<float>;
+template struct SweepAndPrune<double>;
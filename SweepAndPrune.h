@@ -0,0 +1,57 @@
+#pragma once
+
+#include <vector>
+
+template <typename Scalar>
+struct BasicCapsule;
+
+// Sweep and prune over circles and capsule AABBs, with the endpoints on both axes kept sorted between substeps. Bodies
+// move a tiny fraction of a radius per substep, so an insertion sort repairs the order in close to linear time, and
+// every swap of a lower and an upper endpoint settles whether that pair's boxes overlap.
+//
+// Ids 0 .. numCircles - 1 are circles, numCircles + j is capsule j. Capsule-capsule pairs are not kept.
+template <typename Scalar>
+struct SweepAndPrune
+{
+    struct Endpoint
+    {
+        Scalar value;
+
+        int id;
+        bool isUpper;
+    };
+
+    int numCircles = 0;
+    int numCapsules = 0;
+
+    // Fattened box of every id.
+    std::vector<Scalar> lowerX;
+    std::vector<Scalar> upperX;
+    std::vector<Scalar> lowerY;
+    std::vector<Scalar> upperY;
+
+    std::vector<Endpoint> endpointsX;
+    std::vector<Endpoint> endpointsY;
+
+    // partners[id] lists the ids above id whose boxes overlap it, in increasing order, so circles come before capsules.
+    std::vector<std::vector<int>> partners;
+
+    // The world's bodiesVersion at the last update; any other value means ids no longer name the same bodies.
+    int bodiesVersion = -1;
+
+    int rebuilds = 0;
+    long long swaps = 0;
+
+    // Refreshes the boxes (widened by margin times the radius on every side) and repairs the order and the pairs,
+    // or rebuilds both from scratch when bodies were added, removed or reordered since the last update.
+    void update(const Scalar* posX, const Scalar* posY, const Scalar* radius, int numCircles, const BasicCapsule<Scalar>* capsules, int numCapsules, Scalar margin, int bodiesVersion);
+
+    void rebuild();
+
+    void sortAxis(std::vector<Endpoint>& endpoints, const std::vector<Scalar>& lower, const std::vector<Scalar>& upper);
+
+    bool overlaps(int first, int second) const;
+
+    void addPair(int first, int second);
+    void removePair(int first, int second);
+};
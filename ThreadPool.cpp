@@ -0,0 +1,123 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+using namespace std;
+
+// How many times an idle worker polls for a job, yielding in between, before it blocks.
+const int SPIN_COUNT = 4096;
+
+ThreadPool::~ThreadPool()
+{
+    this->resize(1);
+}
+
+int ThreadPool::size() const
+{
+    return (int)this->workers.size() + 1;
+}
+
+void ThreadPool::resize(int numThreads)
+{
+    if (numThreads < 1)
+        numThreads = 1;
+
+    if (numThreads == this->size())
+        return;
+
+    {
+        lock_guard<std::mutex> lock(this->mutex);
+        this->stopping = true;
+    }
+
+    this->jobReady.notify_all();
+
+    for (int t = 0; t < this->workers.size(); t++)
+        this->workers[t].join();
+
+    this->workers.clear();
+    this->stopping = false;
+
+    // Workers start from the current generation, so a job posted before they first run is not missed.
+    int startGeneration = this->generation.load();
+
+    for (int t = 1; t < numThreads; t++)
+        this->workers.push_back(thread(&ThreadPool::workerLoop, this, t, startGeneration));
+}
+
+void ThreadPool::parallelFor(int count, const function<void(int thread, int begin, int end)>& task)
+{
+    if (this->workers.empty() || count <= 1)
+    {
+        task(0, 0, count);
+        return;
+    }
+
+    {
+        lock_guard<std::mutex> lock(this->mutex);
+
+        this->task = &task;
+        this->taskCount = count;
+
+        this->pending.store((int)this->workers.size());
+        this->generation.fetch_add(1, memory_order_release);
+    }
+
+    this->jobReady.notify_all();
+
+    this->runSlice(0);
+
+    while (this->pending.load(memory_order_acquire) > 0)
+        this_thread::yield();
+
+    this->task = nullptr;
+}
+
+void ThreadPool::parallelForEach(int count, const function<void(int thread, int index)>& task)
+{
+    atomic<int> nextIndex{ 0 };
+
+    // One slice per thread, each pulling indices until none are left.
+    this->parallelFor(min(count, this->size()), [&](int thread, int, int)
+    {
+        for (int index = nextIndex.fetch_add(1); index < count; index = nextIndex.fetch_add(1))
+            task(thread, index);
+    });
+}
+
+void ThreadPool::workerLoop(int thread, int startGeneration)
+{
+    int seenGeneration = startGeneration;
+
+    while (true)
+    {
+        for (int spin = 0; spin < SPIN_COUNT && this->generation.load(memory_order_acquire) == seenGeneration; spin++)
+            this_thread::yield();
+
+        {
+            unique_lock<std::mutex> lock(this->mutex);
+
+            this->jobReady.wait(lock, [&] { return this->stopping || this->generation.load(memory_order_acquire) != seenGeneration; });
+
+            if (this->stopping)
+                return;
+
+            seenGeneration = this->generation.load(memory_order_acquire);
+        }
+
+        this->runSlice(thread);
+
+        this->pending.fetch_sub(1, memory_order_release);
+    }
+}
+
+void ThreadPool::runSlice(int thread)
+{
+    int numThreads = this->size();
+
+    int begin = (int)((long long)this->taskCount * thread / numThreads);
+    int end = (int)((long long)this->taskCount * (thread + 1) / numThreads);
+
+    if (begin < end)
+        (*this->task)(thread, begin, end);
+}
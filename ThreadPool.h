@@ -0,0 +1,51 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// A fixed set of worker threads for fork-join loops, the calling thread taking part as thread 0. Between jobs the
+// workers spin (yielding) for a short while before they block, because substeps hand out many small jobs in a row.
+struct ThreadPool
+{
+    std::vector<std::thread> workers;
+
+    std::mutex mutex;
+    std::condition_variable jobReady;
+
+    // The current job; generation is bumped for every new one and pending counts the workers still running it.
+    const std::function<void(int, int, int)>* task = nullptr;
+    int taskCount = 0;
+
+    std::atomic<int> generation{ 0 };
+    std::atomic<int> pending{ 0 };
+
+    bool stopping = false;
+
+    ThreadPool() = default;
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    ~ThreadPool();
+
+    // Number of threads jobs are split over, the caller included.
+    int size() const;
+
+    // Joins the current workers and starts numThreads - 1 new ones; numThreads below 1 counts as 1.
+    void resize(int numThreads);
+
+    // Splits [0, count) into size() contiguous slices and calls task(thread, begin, end) for each, the slices depending
+    // only on count and size(). Returns once every slice is done.
+    void parallelFor(int count, const std::function<void(int thread, int begin, int end)>& task);
+
+    // Calls task(thread, index) for every index in [0, count), handing the indices out one at a time in increasing
+    // order to whichever thread is free, so the longest tasks should come first. Returns once all are done.
+    void parallelForEach(int count, const std::function<void(int thread, int index)>& task);
+
+    void workerLoop(int thread, int startGeneration);
+    void runSlice(int thread);
+};
@@ -0,0 +1,78 @@
+#include "TimeOfImpact.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+template <typename Scalar>
+Scalar sweepPointCircle(Scalar relX, Scalar relY, Scalar motionX, Scalar motionY, Scalar dist)
+{
+    // |rel + motion * t| = dist, the smaller root.
+    Scalar a = motionX * motionX + motionY * motionY;
+    Scalar b = relX * motionX + relY * motionY;
+    Scalar c = relX * relX + relY * relY - dist * dist;
+
+    if (c <= 0 || b >= 0 || a <= 0)
+        return 1;
+
+    Scalar discriminant = b * b - a * c;
+
+    if (discriminant < 0)
+        return 1;
+
+    return min((-b - sqrt(discriminant)) / a, Scalar(1));
+}
+
+template <typename Scalar>
+Scalar sweepPointCapsule(Scalar posX, Scalar posY, Scalar motionX, Scalar motionY, const BasicCapsule<Scalar>& capsule, Scalar dist)
+{
+    // In the capsule's frame: u along the axis from endpoint 1, v across it.
+    Scalar relX = posX - capsule.posX[1];
+    Scalar relY = posY - capsule.posY[1];
+
+    Scalar startU = relX * capsule.axisX + relY * capsule.axisY;
+    Scalar startV = relY * capsule.axisX - relX * capsule.axisY;
+
+    Scalar motionU = motionX * capsule.axisX + motionY * capsule.axisY;
+    Scalar motionV = motionY * capsule.axisX - motionX * capsule.axisY;
+
+    Scalar nearestU = min(max(startU, Scalar(0)), capsule.length);
+
+    if ((startU - nearestU) * (startU - nearestU) + startV * startV <= dist * dist)
+        return 1;
+
+    Scalar timeOfImpact = min(sweepPointCircle(startU, startV, motionU, motionV, dist), sweepPointCircle(startU - capsule.length, startV, motionU, motionV, dist));
+
+    // The sides: the lines dist away from the segment, on the side the point starts.
+    Scalar side = startV > 0 ? Scalar(1) : Scalar(-1);
+
+    if (startV * side > dist && motionV * side < 0)
+    {
+        Scalar t = (startV * side - dist) / (-motionV * side);
+        Scalar u = startU + motionU * t;
+
+        if (t < timeOfImpact && u >= 0 && u <= capsule.length)
+            timeOfImpact = t;
+    }
+
+    return timeOfImpact;
+}
+
+template <typename Scalar>
+Scalar sweepPointWall(Scalar separation, Scalar motion)
+{
+    if (separation <= 0 || motion <= separation)
+        return 1;
+
+    return separation / motion;
+}
+
+template float sweepPointCircle(float relX, float relY, float motionX, float motionY, float dist);
+template double sweepPointCircle(double relX, double relY, double motionX, double motionY, double dist);
+
+template float sweepPointCapsule(float posX, float posY, float motionX, float motionY, const BasicCapsule<float>& capsule, float dist);
+template double sweepPointCapsule(double posX, double posY, double motionX, double motionY, const BasicCapsule<double>& capsule, double dist);
+
+template float sweepPointWall(float separation, float motion);
+template double sweepPointWall(double separation, double motion);
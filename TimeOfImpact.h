@@ -0,0 +1,20 @@
+#pragma once
+
+#include "World.h"
+
+// Swept tests for continuous collision detection. A point starts at (relX, relY) relative to the target and moves by
+// (motionX, motionY) over the step; each function returns the fraction of the step, in [0, 1], at which the point first
+// comes within dist of the target, or 1 if it does not. A point that already starts within dist also gets 1: the
+// discrete contact passes handle it. Circles are swept as their centres against targets inflated by their radius.
+
+// Against a point, so dist is the sum of the two radii for a pair of circles moving relative to each other.
+template <typename Scalar>
+Scalar sweepPointCircle(Scalar relX, Scalar relY, Scalar motionX, Scalar motionY, Scalar dist);
+
+// Against a capsule's segment, with (posX, posY) in world coordinates; dist adds the circle's radius to the capsule's.
+template <typename Scalar>
+Scalar sweepPointCapsule(Scalar posX, Scalar posY, Scalar motionX, Scalar motionY, const BasicCapsule<Scalar>& capsule, Scalar dist);
+
+// Against a wall: separation is the distance still free towards it and motion the displacement towards it.
+template <typename Scalar>
+Scalar sweepPointWall(Scalar separation, Scalar motion);
@@ -0,0 +1,113 @@
+#include "Trace.h"
+
+#ifdef PHYSICS_TRACING
+
+#include <fstream>
+#include <vector>
+#include <mutex>
+#include <memory>
+
+using namespace std;
+
+struct TraceBuffer
+{
+    int threadId;
+
+    vector<TraceEvent> events;
+    int64_t written;
+
+    TraceBuffer(int threadId)
+    {
+        this->threadId = threadId;
+
+        this->events.resize(PHYSICS_TRACE_CAPACITY);
+        this->written = 0;
+    }
+};
+
+mutex traceBuffersMutex;
+vector<unique_ptr<TraceBuffer>> traceBuffers;
+
+const chrono::steady_clock::time_point traceEpoch = chrono::steady_clock::now();
+
+TraceBuffer* registerTraceBuffer()
+{
+    lock_guard<mutex> lock(traceBuffersMutex);
+
+    traceBuffers.push_back(make_unique<TraceBuffer>((int)traceBuffers.size() + 1));
+
+    return traceBuffers.back().get();
+}
+
+int64_t traceNowNs()
+{
+    return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - traceEpoch).count();
+}
+
+void traceRecord(const char* name, int index, int64_t startNs, int64_t durationNs)
+{
+    thread_local TraceBuffer* buffer = registerTraceBuffer();
+
+    TraceEvent& event = buffer->events[buffer->written % PHYSICS_TRACE_CAPACITY];
+
+    event.name = name;
+    event.index = index;
+    event.startNs = startNs;
+    event.durationNs = durationNs;
+
+    buffer->written++;
+}
+
+bool traceWriteChromeJson(const char* path)
+{
+    ofstream file(path);
+
+    if (!file)
+        return false;
+
+    lock_guard<mutex> lock(traceBuffersMutex);
+
+    file << fixed;
+    file.precision(3);
+
+    file << "{\"traceEvents\":[\n";
+
+    bool first = true;
+
+    for (int i = 0; i < traceBuffers.size(); i++)
+    {
+        TraceBuffer& buffer = *traceBuffers[i];
+
+        int64_t firstEvent = buffer.written > PHYSICS_TRACE_CAPACITY ? buffer.written - PHYSICS_TRACE_CAPACITY : 0;
+
+        for (int64_t e = firstEvent; e < buffer.written; e++)
+        {
+            const TraceEvent& event = buffer.events[e % PHYSICS_TRACE_CAPACITY];
+
+            if (!first)
+                file << ",\n";
+            first = false;
+
+            file << "{\"name\":\"" << event.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer.threadId
+                << ",\"ts\":" << event.startNs / 1000.0 << ",\"dur\":" << event.durationNs / 1000.0;
+
+            if (event.index >= 0)
+                file << ",\"args\":{\"index\":" << event.index << "}";
+
+            file << "}";
+        }
+    }
+
+    file << "\n]}\n";
+
+    return (bool)file;
+}
+
+#else
+
+bool traceWriteChromeJson(const char*)
+{
+    return false;
+}
+
+#endif
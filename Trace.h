@@ -0,0 +1,70 @@
+#pragma once
+
+// Scoped frame-phase tracing, dumped in the Chrome trace_event format (chrome://tracing, Perfetto).
+// Define PHYSICS_TRACING to compile it in; without it the TRACE_* macros expand to nothing.
+
+#ifdef PHYSICS_TRACING
+
+#include <chrono>
+#include <cstdint>
+
+#ifndef PHYSICS_TRACE_CAPACITY
+#define PHYSICS_TRACE_CAPACITY (1 << 20)
+#endif
+
+struct TraceEvent
+{
+    const char* name;
+    int index;
+
+    int64_t startNs;
+    int64_t durationNs;
+};
+
+int64_t traceNowNs();
+
+// Appends to the calling thread's ring buffer; the oldest events are overwritten once it is full.
+void traceRecord(const char* name, int index, int64_t startNs, int64_t durationNs);
+
+struct TraceScope
+{
+    const char* name;
+    int index;
+
+    int64_t startNs;
+
+    TraceScope(const char* name, int index = -1)
+    {
+        this->name = name;
+        this->index = index;
+
+        this->startNs = traceNowNs();
+    }
+
+    ~TraceScope()
+    {
+        traceRecord(this->name, this->index, this->startNs, traceNowNs() - this->startNs);
+    }
+};
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+
+#define TRACE_SCOPE(name) TraceScope TRACE_CONCAT(traceScope, __LINE__)(name)
+// index (substep or frame number) is exported as args.index so individual substeps can be told apart.
+#define TRACE_SCOPE_INDEX(name, index) TraceScope TRACE_CONCAT(traceScope, __LINE__)(name, index)
+
+const bool TRACING_ENABLED = true;
+
+#else
+
+#define TRACE_SCOPE(name) ((void)0)
+#define TRACE_SCOPE_INDEX(name, index) ((void)0)
+
+const bool TRACING_ENABLED = false;
+
+#endif
+
+// Writes every thread's buffered events to path. Call it while no traced code is running.
+// Returns false if the file could not be written or tracing is compiled out.
+bool traceWriteChromeJson(const char* path);
@@ -0,0 +1,123 @@
+#include "UniformGrid.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+template <typename Scalar>
+void UniformGrid<Scalar>::build(const Scalar* posX, const Scalar* posY, const Scalar* radius, int numBodies, Scalar width, Scalar height, Scalar margin)
+{
+    Scalar maxRadius = 0;
+
+    for (int i = 0; i < numBodies; i++)
+        maxRadius = max(maxRadius, radius[i]);
+
+    this->cellSize = max(2 * maxRadius * (1 + margin), Scalar(1));
+
+    // A huge, sparse box would need far more cells than bodies; grow the cells instead.
+    double maxCells = 4.0 * numBodies + 64.0;
+
+    while (ceil(width / this->cellSize) * ceil(height / this->cellSize) > maxCells)
+        this->cellSize *= 2;
+
+    this->minX = -width / 2;
+    this->minY = -height / 2;
+
+    this->cellsX = max(1, (int)ceil(width / this->cellSize));
+    this->cellsY = max(1, (int)ceil(height / this->cellSize));
+
+    int numCells = this->cellsX * this->cellsY;
+
+    this->cellStart.assign(numCells + 1, 0);
+    this->cellBodies.resize(numBodies);
+    this->bodyCell.resize(numBodies);
+
+    for (int i = 0; i < numBodies; i++)
+    {
+        int cell = this->cellY(posY[i]) * this->cellsX + this->cellX(posX[i]);
+
+        this->bodyCell[i] = cell;
+        this->cellStart[cell + 1]++;
+    }
+
+    for (int c = 0; c < numCells; c++)
+        this->cellStart[c + 1] += this->cellStart[c];
+
+    // Scatter in index order so every cell lists its bodies sorted; cellStart[c] is used as the write cursor and restored after.
+    for (int i = 0; i < numBodies; i++)
+        this->cellBodies[this->cellStart[this->bodyCell[i]]++] = i;
+
+    for (int c = numCells; c > 0; c--)
+        this->cellStart[c] = this->cellStart[c - 1];
+
+    this->cellStart[0] = 0;
+}
+
+template <typename Scalar>
+int UniformGrid<Scalar>::cellX(Scalar x) const
+{
+    int cell = (int)floor((x - this->minX) / this->cellSize);
+
+    return min(max(cell, 0), this->cellsX - 1);
+}
+
+template <typename Scalar>
+int UniformGrid<Scalar>::cellY(Scalar y) const
+{
+    int cell = (int)floor((y - this->minY) / this->cellSize);
+
+    return min(max(cell, 0), this->cellsY - 1);
+}
+
+template <typename Scalar>
+void UniformGrid<Scalar>::queryNeighbours(int body, vector<int>& neighbours) const
+{
+    int first = (int)neighbours.size();
+
+    int cellX = this->bodyCell[body] % this->cellsX;
+    int cellY = this->bodyCell[body] / this->cellsX;
+
+    int firstX = max(cellX - 1, 0);
+    int lastX = min(cellX + 1, this->cellsX - 1);
+
+    for (int y = max(cellY - 1, 0); y <= min(cellY + 1, this->cellsY - 1); y++)
+    {
+        // The cells of one row are adjacent in cellBodies, so the three of them are a single range.
+        const int* begin = this->cellBodies.data() + this->cellStart[y * this->cellsX + firstX];
+        const int* end = this->cellBodies.data() + this->cellStart[y * this->cellsX + lastX + 1];
+
+        for (const int* j = begin; j != end; j++)
+        {
+            if (*j > body)
+                neighbours.push_back(*j);
+        }
+    }
+
+    sort(neighbours.begin() + first, neighbours.end());
+}
+
+template <typename Scalar>
+void UniformGrid<Scalar>::queryAround(int body, vector<int>& neighbours) const
+{
+    int cellX = this->bodyCell[body] % this->cellsX;
+    int cellY = this->bodyCell[body] / this->cellsX;
+
+    int firstX = max(cellX - 1, 0);
+    int lastX = min(cellX + 1, this->cellsX - 1);
+
+    for (int y = max(cellY - 1, 0); y <= min(cellY + 1, this->cellsY - 1); y++)
+    {
+        const int* begin = this->cellBodies.data() + this->cellStart[y * this->cellsX + firstX];
+        const int* end = this->cellBodies.data() + this->cellStart[y * this->cellsX + lastX + 1];
+
+        for (const int* j = begin; j != end; j++)
+        {
+            if (*j != body)
+                neighbours.push_back(*j);
+        }
+    }
+}
+
+template struct UniformGrid<float>;
+template struct UniformGrid<double>;
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <vector>
+
+// Uniform grid over the world's box, rebuilt from scratch with a counting sort. Cells are at least as wide as the
+// largest circle's diameter (plus a margin), so every overlapping pair lies in the same or in neighbouring cells.
+// Bodies outside the box are clamped into the border cells, which keeps that guarantee.
+template <typename Scalar>
+struct UniformGrid
+{
+    Scalar cellSize = 0;
+
+    Scalar minX = 0;
+    Scalar minY = 0;
+
+    int cellsX = 0;
+    int cellsY = 0;
+
+    // Bodies sorted by cell: cell c holds cellBodies[cellStart[c]] .. cellBodies[cellStart[c + 1] - 1], in increasing index order.
+    std::vector<int> cellStart;
+    std::vector<int> cellBodies;
+
+    std::vector<int> bodyCell;
+
+    // margin is a fraction of the diameter added to the cell size, covering what bodies move while one pass resolves contacts.
+    void build(const Scalar* posX, const Scalar* posY, const Scalar* radius, int numBodies, Scalar width, Scalar height, Scalar margin);
+
+    int cellX(Scalar x) const;
+    int cellY(Scalar y) const;
+
+    // Appends every body in the 3x3 cells around body's cell with an index greater than body, in increasing order.
+    void queryNeighbours(int body, std::vector<int>& neighbours) const;
+
+    // Appends every other body in the 3x3 cells around body's cell, in cell order.
+    void queryAround(int body, std::vector<int>& neighbours) const;
+};
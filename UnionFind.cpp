@@ -0,0 +1,44 @@
+#include "UnionFind.h"
+
+using namespace std;
+
+void UnionFind::reset(int size)
+{
+    this->parent.resize(size);
+    this->setSize.assign(size, 1);
+
+    for (int i = 0; i < size; i++)
+        this->parent[i] = i;
+}
+
+int UnionFind::find(int element)
+{
+    while (this->parent[element] != element)
+    {
+        this->parent[element] = this->parent[this->parent[element]];
+        element = this->parent[element];
+    }
+
+    return element;
+}
+
+int UnionFind::unite(int a, int b)
+{
+    a = this->find(a);
+    b = this->find(b);
+
+    if (a == b)
+        return a;
+
+    if (this->setSize[a] < this->setSize[b])
+    {
+        int swapped = a;
+        a = b;
+        b = swapped;
+    }
+
+    this->parent[b] = a;
+    this->setSize[a] += this->setSize[b];
+
+    return a;
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <vector>
+
+// Disjoint sets over 0 .. size - 1, with path halving and union by size.
+struct UnionFind
+{
+    std::vector<int> parent;
+    std::vector<int> setSize;
+
+    // Puts every element in a set of its own.
+    void reset(int size);
+
+    int find(int element);
+
+    // Merges the sets of a and b and returns the representative of the result.
+    int unite(int a, int b);
+};
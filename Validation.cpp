@@ -0,0 +1,267 @@
+#include "Validation.h"
+
+#include <sstream>
+
+#include <cmath>
+
+using namespace std;
+
+// Dense indices of the circles in the order of their registry slots, which reordering, sleeping and despawning
+// leave alone, so a trajectory can be diffed against one whose circles were stored in another order.
+template <typename Scalar>
+void captureOrder(const BasicWorld<Scalar>& world, vector<int>& order)
+{
+    const BodyRegistry& registry = world.circleRegistry;
+
+    order.clear();
+
+    for (int slot = 0; slot < registry.slots.size(); slot++)
+    {
+        if (registry.slots[slot].denseIndex != -1)
+            order.push_back(registry.slots[slot].denseIndex);
+    }
+}
+
+template <typename Scalar>
+void captureState(const BasicWorld<Scalar>& world, vector<double>& values)
+{
+    vector<int> order;
+    captureOrder(world, order);
+
+    values.clear();
+
+    for (int k = 0; k < order.size(); k++)
+    {
+        int i = order[k];
+
+        values.push_back(world.circles.posX[i]);
+        values.push_back(world.circles.posY[i]);
+        values.push_back(world.circles.speedX[i]);
+        values.push_back(world.circles.speedY[i]);
+    }
+
+    for (int j = 0; j < world.capsules.size(); j++)
+    {
+        values.push_back(world.capsules[j].posX[0]);
+        values.push_back(world.capsules[j].posY[0]);
+        values.push_back(world.capsules[j].posX[1]);
+        values.push_back(world.capsules[j].posY[1]);
+    }
+}
+
+template <typename Scalar>
+double computeEnergy(const BasicWorld<Scalar>& world, const vector<double>& values)
+{
+    vector<int> order;
+    captureOrder(world, order);
+
+    double energy = 0.0;
+
+    for (int k = 0; k < order.size(); k++)
+    {
+        double posY = values[4 * k + 1];
+        double speedX = values[4 * k + 2];
+        double speedY = values[4 * k + 3];
+
+        double mass = world.circles.mass[order[k]];
+
+        energy += 0.5 * mass * (speedX * speedX + speedY * speedY);
+        energy += mass * SCALAR_GRAVITY * (posY + world.height / 2.0);
+    }
+
+    return energy;
+}
+
+template <typename Scalar>
+void computeMomentum(const BasicWorld<Scalar>& world, const vector<double>& values, double& momentumX, double& momentumY)
+{
+    vector<int> order;
+    captureOrder(world, order);
+
+    momentumX = 0.0;
+    momentumY = 0.0;
+
+    for (int k = 0; k < order.size(); k++)
+    {
+        momentumX += world.circles.mass[order[k]] * values[4 * k + 2];
+        momentumY += world.circles.mass[order[k]] * values[4 * k + 3];
+    }
+}
+
+bool GoldenWriter::open(const string& path, const GoldenHeader& header)
+{
+    this->file.open(path);
+
+    if (!this->file)
+        return false;
+
+    this->file.precision(17);
+
+    this->file << "golden 2\n";
+    this->file << "circles " << header.numCircles << " capsules " << header.numCapsules << " frames " << header.frames
+        << " substeps " << header.numberOfSimulations << " dt " << header.frameDeltaTime << " seed " << header.seed
+        << " radius " << header.minRadius << " " << header.maxRadius << "\n";
+
+    return (bool)this->file;
+}
+
+template <typename Scalar>
+void GoldenWriter::writeFrame(const BasicWorld<Scalar>& world)
+{
+    captureState(world, this->values);
+
+    for (int k = 0; k < this->values.size(); k++)
+        this->file << this->values[k] << (k + 1 < this->values.size() ? " " : "");
+
+    this->file << "\n";
+}
+
+bool GoldenReader::open(const string& path)
+{
+    this->file.open(path);
+
+    if (!this->file)
+        return false;
+
+    string magic;
+    int version;
+
+    this->file >> magic >> version;
+
+    if (magic != "golden" || (version != 1 && version != 2))
+        return false;
+
+    string key;
+
+    this->file >> key >> this->header.numCircles >> key >> this->header.numCapsules >> key >> this->header.frames
+        >> key >> this->header.numberOfSimulations >> key >> this->header.frameDeltaTime >> key >> this->header.seed;
+
+    // Version 1 files were always recorded with the default radius range.
+    if (version >= 2)
+        this->file >> key >> this->header.minRadius >> this->header.maxRadius;
+
+    return (bool)this->file;
+}
+
+bool GoldenReader::readFrame(vector<double>& values)
+{
+    values.resize(4 * (this->header.numCircles + this->header.numCapsules));
+
+    for (int k = 0; k < values.size(); k++)
+        this->file >> values[k];
+
+    return (bool)this->file;
+}
+
+template <typename Scalar>
+bool GoldenComparator::compareFrame(int frame, const BasicWorld<Scalar>& world, const vector<double>& reference)
+{
+    captureState(world, this->values);
+
+    this->framesCompared++;
+
+    bool frameFailed = this->values.size() != reference.size();
+
+    stringstream failure;
+
+    if (frameFailed)
+        failure << "frame " << frame << ": " << this->values.size() << " values, reference has " << reference.size();
+
+    for (int k = 0; k < this->values.size() && k < reference.size(); k++)
+    {
+        double absoluteError = fabs(this->values[k] - reference[k]);
+        double relativeError = absoluteError / max(fabs(reference[k]), 1e-300);
+
+        this->maxAbsoluteError = max(this->maxAbsoluteError, absoluteError);
+        this->maxRelativeError = max(this->maxRelativeError, relativeError);
+
+        // Like numpy.isclose: a value passes if it is within either the absolute or the relative tolerance.
+        if (!(absoluteError <= this->tolerances.absoluteTolerance + this->tolerances.relativeTolerance * fabs(reference[k])) && !frameFailed)
+        {
+            frameFailed = true;
+
+            const char* fieldNames[4] = { "posX", "posY", "speedX", "speedY" };
+            const char* capsuleFieldNames[4] = { "posX[0]", "posY[0]", "posX[1]", "posY[1]" };
+
+            int numCircleValues = 4 * world.circles.size();
+
+            failure << "frame " << frame << ": ";
+
+            if (k < numCircleValues)
+                failure << "circle " << k / 4 << " " << fieldNames[k % 4];
+            else
+                failure << "capsule " << (k - numCircleValues) / 4 << " " << capsuleFieldNames[(k - numCircleValues) % 4];
+
+            failure << " is " << this->values[k] << ", reference " << reference[k];
+        }
+    }
+
+    if (this->values.size() == reference.size())
+    {
+        double energy = computeEnergy(world, this->values);
+        double referenceEnergy = computeEnergy(world, reference);
+
+        double energyDrift = fabs(energy - referenceEnergy) / max(fabs(referenceEnergy), 1e-300);
+
+        double momentumX, momentumY;
+        double referenceMomentumX, referenceMomentumY;
+
+        computeMomentum(world, this->values, momentumX, momentumY);
+        computeMomentum(world, reference, referenceMomentumX, referenceMomentumY);
+
+        // Normalized by the sum of per-body momentum magnitudes, since the total itself is near zero for a resting pile.
+        double momentumScale = 0.0;
+
+        for (int i = 0; i < world.circles.size(); i++)
+            momentumScale += world.circles.mass[i] * sqrt(reference[4 * i + 2] * reference[4 * i + 2] + reference[4 * i + 3] * reference[4 * i + 3]);
+
+        double momentumDifference = sqrt((momentumX - referenceMomentumX) * (momentumX - referenceMomentumX) + (momentumY - referenceMomentumY) * (momentumY - referenceMomentumY));
+
+        double momentumDrift = momentumDifference / max(momentumScale, 1e-300);
+
+        this->maxEnergyDrift = max(this->maxEnergyDrift, energyDrift);
+        this->maxMomentumDrift = max(this->maxMomentumDrift, momentumDrift);
+
+        if (energyDrift > this->tolerances.energyDrift && !frameFailed)
+        {
+            frameFailed = true;
+            failure << "frame " << frame << ": energy drift " << energyDrift;
+        }
+
+        if (momentumDrift > this->tolerances.momentumDrift && !frameFailed)
+        {
+            frameFailed = true;
+            failure << "frame " << frame << ": momentum drift " << momentumDrift;
+        }
+    }
+
+    if (frameFailed)
+    {
+        this->failedFrames++;
+
+        if (this->firstFailure.empty())
+            this->firstFailure = failure.str();
+    }
+
+    return !frameFailed;
+}
+
+bool GoldenComparator::passed() const
+{
+    return this->failedFrames == 0;
+}
+
+template void captureState(const BasicWorld<float>& world, vector<double>& values);
+template void captureState(const BasicWorld<double>& world, vector<double>& values);
+
+template double computeEnergy(const BasicWorld<float>& world, const vector<double>& values);
+template double computeEnergy(const BasicWorld<double>& world, const vector<double>& values);
+
+template void computeMomentum(const BasicWorld<float>& world, const vector<double>& values, double& momentumX, double& momentumY);
+template void computeMomentum(const BasicWorld<double>& world, const vector<double>& values, double& momentumX, double& momentumY);
+
+template void GoldenWriter::writeFrame(const BasicWorld<float>& world);
+template void GoldenWriter::writeFrame(const BasicWorld<double>& world);
+
+template bool GoldenComparator::compareFrame(int frame, const BasicWorld<float>& world, const vector<double>& reference);
+template bool GoldenComparator::compareFrame(int frame, const BasicWorld<double>& world, const vector<double>& reference);
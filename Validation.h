@@ -0,0 +1,95 @@
+#pragma once
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "World.h"
+
+// Golden-trajectory files: per-frame positions and velocities of every circle and endpoints of every capsule,
+// recorded from the reference path so alternative collision/integration code can be diffed against it.
+
+struct GoldenHeader
+{
+    int numCircles = 0;
+    int numCapsules = 0;
+
+    int frames = 0;
+    int numberOfSimulations = NUMBER_OF_SIMULATIONS;
+
+    double frameDeltaTime = 0.0;
+
+    unsigned int seed = 0;
+
+    // Radius range of the spawned circles.
+    double minRadius = SPAWN_MIN_RADIUS;
+    double maxRadius = SPAWN_MAX_RADIUS;
+};
+
+struct GoldenTolerances
+{
+    double absoluteTolerance = 1e-6;
+    double relativeTolerance = 1e-6;
+
+    // Allowed relative difference of total energy / momentum magnitude against the reference, per frame.
+    double energyDrift = 1e-3;
+    double momentumDrift = 1e-3;
+};
+
+// Circles are taken in the order of their registry slots, not of the dense arrays, so reordering and sleeping do not
+// change the capture. Each circle contributes posX, posY, speedX, speedY; capsule j contributes posX[0], posY[0],
+// posX[1], posY[1]. Values are widened to double, so a float world can be diffed against a double reference.
+template <typename Scalar>
+void captureState(const BasicWorld<Scalar>& world, std::vector<double>& values);
+
+template <typename Scalar>
+double computeEnergy(const BasicWorld<Scalar>& world, const std::vector<double>& values);
+
+template <typename Scalar>
+void computeMomentum(const BasicWorld<Scalar>& world, const std::vector<double>& values, double& momentumX, double& momentumY);
+
+struct GoldenWriter
+{
+    std::ofstream file;
+
+    std::vector<double> values;
+
+    bool open(const std::string& path, const GoldenHeader& header);
+
+    template <typename Scalar>
+    void writeFrame(const BasicWorld<Scalar>& world);
+};
+
+struct GoldenReader
+{
+    std::ifstream file;
+
+    GoldenHeader header;
+
+    bool open(const std::string& path);
+
+    bool readFrame(std::vector<double>& values);
+};
+
+struct GoldenComparator
+{
+    GoldenTolerances tolerances;
+
+    std::vector<double> values;
+
+    int framesCompared = 0;
+    int failedFrames = 0;
+
+    double maxAbsoluteError = 0.0;
+    double maxRelativeError = 0.0;
+    double maxEnergyDrift = 0.0;
+    double maxMomentumDrift = 0.0;
+
+    std::string firstFailure;
+
+    // Compares the world against one reference frame; returns false if any tolerance is exceeded.
+    template <typename Scalar>
+    bool compareFrame(int frame, const BasicWorld<Scalar>& world, const std::vector<double>& reference);
+
+    bool passed() const;
+};
@@ -0,0 +1,120 @@
+#include "VerletList.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+template <typename Scalar>
+bool VerletList<Scalar>::update(const Scalar* posX, const Scalar* posY, const Scalar* radius, int numBodies, Scalar width, Scalar height, Scalar margin, int bodiesVersion)
+{
+    this->updates++;
+
+    if (bodiesVersion != this->bodiesVersion || numBodies != this->buildPosX.size())
+    {
+        this->bodiesVersion = bodiesVersion;
+        this->rebuild(posX, posY, radius, numBodies, width, height, margin);
+        return true;
+    }
+
+    Scalar maxDisplacementSquared = 0;
+
+    for (int i = 0; i < numBodies; i++)
+    {
+        Scalar deltaX = posX[i] - this->buildPosX[i];
+        Scalar deltaY = posY[i] - this->buildPosY[i];
+
+        maxDisplacementSquared = max(maxDisplacementSquared, deltaX * deltaX + deltaY * deltaY);
+    }
+
+    this->maxDisplacement = sqrt(maxDisplacementSquared);
+
+    if (4 * maxDisplacementSquared <= this->skin * this->skin)
+        return false;
+
+    this->rebuild(posX, posY, radius, numBodies, width, height, margin);
+
+    return true;
+}
+
+template <typename Scalar>
+void VerletList<Scalar>::rebuild(const Scalar* posX, const Scalar* posY, const Scalar* radius, int numBodies, Scalar width, Scalar height, Scalar margin)
+{
+    this->rebuilds++;
+
+    this->maxDisplacement = 0;
+
+    this->buildPosX.assign(posX, posX + numBodies);
+    this->buildPosY.assign(posY, posY + numBodies);
+
+    Scalar maxRadius = 0;
+
+    for (int i = 0; i < numBodies; i++)
+        maxRadius = max(maxRadius, radius[i]);
+
+    // Cells as wide as the longest possible listed distance, so every listed pair is in neighbouring cells.
+    Scalar cellMargin = maxRadius > 0 ? margin + this->skin / (2 * maxRadius) : Scalar(0);
+
+    this->grid.build(posX, posY, radius, numBodies, width, height, cellMargin);
+
+    this->pairStart.resize(numBodies + 1);
+    this->partners.clear();
+
+    for (int i = 0; i < numBodies; i++)
+    {
+        this->pairStart[i] = (int)this->partners.size();
+
+        this->neighbours.clear();
+        this->grid.queryNeighbours(i, this->neighbours);
+
+        for (int k = 0; k < this->neighbours.size(); k++)
+        {
+            int j = this->neighbours[k];
+
+            Scalar deltaX = posX[j] - posX[i];
+            Scalar deltaY = posY[j] - posY[i];
+
+            Scalar cutoff = (radius[i] + radius[j]) * (1 + margin) + this->skin;
+
+            if (deltaX * deltaX + deltaY * deltaY <= cutoff * cutoff)
+                this->partners.push_back(j);
+        }
+    }
+
+    this->pairStart[numBodies] = (int)this->partners.size();
+}
+
+template <typename Scalar>
+bool VerletList<Scalar>::movedTooFar(const Scalar* posX, const Scalar* posY, int body) const
+{
+    Scalar limitSquared = this->skin * this->skin / 4;
+
+    Scalar deltaX = posX[body] - this->buildPosX[body];
+    Scalar deltaY = posY[body] - this->buildPosY[body];
+
+    if (deltaX * deltaX + deltaY * deltaY > limitSquared)
+        return true;
+
+    for (int k = this->pairStart[body]; k < this->pairStart[body + 1]; k++)
+    {
+        int j = this->partners[k];
+
+        deltaX = posX[j] - this->buildPosX[j];
+        deltaY = posY[j] - this->buildPosY[j];
+
+        if (deltaX * deltaX + deltaY * deltaY > limitSquared)
+            return true;
+    }
+
+    return false;
+}
+
+template <typename Scalar>
+void VerletList<Scalar>::invalidate()
+{
+    this->bodiesVersion = -1;
+    this->invalidations++;
+}
+
+template struct VerletList<float>;
+template struct VerletList<double>;
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <vector>
+
+#include "UniformGrid.h"
+
+// Verlet neighbour lists: every pair closer than the sum of radii (widened by a margin) plus skin is listed once and
+// reused across substeps. A listed-out pair can only come into contact after the two bodies closed a gap of skin
+// between them, so the lists stay complete until some body has moved more than half the skin since the build. The
+// margin covers what one body's contacts push around; pushes that chain through many bodies within a pass are caught
+// by checking every resolved body with movedTooFar, and the owner finishes that pass with another broadphase.
+template <typename Scalar>
+struct VerletList
+{
+    // Extra distance, in world units, a pair may be apart and still be listed. Larger skins rebuild less often but
+    // list more pairs.
+    Scalar skin = 0;
+
+    // Positions at the last build, which displacements are measured from.
+    std::vector<Scalar> buildPosX;
+    std::vector<Scalar> buildPosY;
+
+    // Body i's partners are partners[pairStart[i]] .. partners[pairStart[i + 1] - 1], all above i and in increasing order.
+    std::vector<int> pairStart;
+    std::vector<int> partners;
+
+    UniformGrid<Scalar> grid;
+    std::vector<int> neighbours;
+
+    // The owner's bodiesVersion at the last build; any other value means indices no longer name the same bodies.
+    int bodiesVersion = -1;
+
+    // Statistics since construction: updates is one per pass, rebuilds how many of those had to rebuild the lists and
+    // invalidations how many passes gave up on them halfway.
+    long long updates = 0;
+    int rebuilds = 0;
+    int invalidations = 0;
+
+    // Largest displacement since the last build, as of the last update.
+    Scalar maxDisplacement = 0;
+
+    // Rebuilds the lists if bodies changed or one of them moved more than skin / 2 since the last build; returns whether it did.
+    // margin is a fraction of the sum of radii, like the other broadphases' margins.
+    bool update(const Scalar* posX, const Scalar* posY, const Scalar* radius, int numBodies, Scalar width, Scalar height, Scalar margin, int bodiesVersion);
+
+    void rebuild(const Scalar* posX, const Scalar* posY, const Scalar* radius, int numBodies, Scalar width, Scalar height, Scalar margin);
+
+    // Whether body or one of its partners has moved more than skin / 2 since the build.
+    bool movedTooFar(const Scalar* posX, const Scalar* posY, int body) const;
+
+    // Makes the next update rebuild the lists.
+    void invalidate();
+};
@@ -0,0 +1,2747 @@
+#include "World.h"
+#include "Trace.h"
+#include "InputRecording.h"
+#include "SimdKernels.h"
+#include "TimeOfImpact.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+
+using namespace std;
+
+template <typename Scalar>
+BasicCircle<Scalar>::BasicCircle(Scalar posX, Scalar posY, Scalar radius, double red, double green, double blue, Scalar mass, Scalar speedX, Scalar speedY)
+{
+    this->posX = posX;
+    this->posY = posY;
+    this->radius = radius;
+
+    this->mass = mass;
+
+    this->speedX = speedX;
+    this->speedY = speedY;
+
+    this->red = red;
+    this->green = green;
+    this->blue = blue;
+
+    this->restitution = DEFAULT_RESTITUTION;
+
+    this->playerControlled = false;
+}
+
+template <typename Scalar>
+int BasicCircleArrays<Scalar>::size() const
+{
+    return (int)this->posX.size();
+}
+
+template <typename Scalar>
+void BasicCircleArrays<Scalar>::reserve(int capacity)
+{
+    this->posX.reserve(capacity);
+    this->posY.reserve(capacity);
+
+    this->speedX.reserve(capacity);
+    this->speedY.reserve(capacity);
+
+    this->radius.reserve(capacity);
+    this->mass.reserve(capacity);
+}
+
+template <typename Scalar>
+void BasicCircleArrays<Scalar>::add(const BasicCircle<Scalar>& circle)
+{
+    this->posX.push_back(circle.posX);
+    this->posY.push_back(circle.posY);
+
+    this->speedX.push_back(circle.speedX);
+    this->speedY.push_back(circle.speedY);
+
+    this->radius.push_back(circle.radius);
+    this->mass.push_back(circle.mass);
+}
+
+template <typename Scalar>
+void BasicCircleArrays<Scalar>::swapRemove(int i)
+{
+    int last = this->size() - 1;
+
+    this->posX[i] = this->posX[last];
+    this->posY[i] = this->posY[last];
+
+    this->speedX[i] = this->speedX[last];
+    this->speedY[i] = this->speedY[last];
+
+    this->radius[i] = this->radius[last];
+    this->mass[i] = this->mass[last];
+
+    this->posX.pop_back();
+    this->posY.pop_back();
+
+    this->speedX.pop_back();
+    this->speedY.pop_back();
+
+    this->radius.pop_back();
+    this->mass.pop_back();
+}
+
+template <typename Scalar>
+void permuteArray(AlignedVector<Scalar>& values, const vector<int>& order, AlignedVector<Scalar>& scratch)
+{
+    scratch.resize(values.size());
+
+    for (int n = 0; n < order.size(); n++)
+        scratch[n] = values[order[n]];
+
+    copy(scratch.begin(), scratch.end(), values.begin());
+}
+
+template <typename Scalar>
+void BasicCircleArrays<Scalar>::permute(const vector<int>& order)
+{
+    AlignedVector<Scalar> scratch;
+
+    permuteArray(this->posX, order, scratch);
+    permuteArray(this->posY, order, scratch);
+
+    permuteArray(this->speedX, order, scratch);
+    permuteArray(this->speedY, order, scratch);
+
+    permuteArray(this->radius, order, scratch);
+    permuteArray(this->mass, order, scratch);
+}
+
+template <typename Scalar>
+void BasicCircleArrays<Scalar>::swap(int a, int b)
+{
+    std::swap(this->posX[a], this->posX[b]);
+    std::swap(this->posY[a], this->posY[b]);
+
+    std::swap(this->speedX[a], this->speedX[b]);
+    std::swap(this->speedY[a], this->speedY[b]);
+
+    std::swap(this->radius[a], this->radius[b]);
+    std::swap(this->mass[a], this->mass[b]);
+}
+
+template <typename Scalar>
+BasicCapsule<Scalar>::BasicCapsule(Scalar pos0X, Scalar pos0Y, Scalar pos1X, Scalar pos1Y, Scalar radius, double red, double green, double blue)
+{
+    this->posX[0] = pos0X;
+    this->posY[0] = pos0Y;
+
+    this->posX[1] = pos1X;
+    this->posY[1] = pos1Y;
+
+    this->radius = radius;
+
+    this->speedX = 0;
+    this->speedY = 0;
+    this->angularSpeed = 0;
+
+    this->red = red;
+    this->green = green;
+    this->blue = blue;
+
+    this->playerControlled = false;
+
+    this->updateGeometry();
+}
+
+template <typename Scalar>
+void BasicCapsule<Scalar>::rotate(Scalar angle)
+{
+    Scalar middleX = (this->posX[0] + this->posX[1]) / 2;
+    Scalar middleY = (this->posY[0] + this->posY[1]) / 2;
+
+    this->posX[0] -= middleX;
+    this->posX[1] -= middleX;
+
+    this->posY[0] -= middleY;
+    this->posY[1] -= middleY;
+
+    Scalar new0X = this->posX[0] * cos(angle) - this->posY[0] * sin(angle);
+    Scalar new0Y = this->posX[0] * sin(angle) + this->posY[0] * cos(angle);
+
+    Scalar new1X = this->posX[1] * cos(angle) - this->posY[1] * sin(angle);
+    Scalar new1Y = this->posX[1] * sin(angle) + this->posY[1] * cos(angle);
+
+    this->posX[0] = new0X;
+    this->posY[0] = new0Y;
+
+    this->posX[1] = new1X;
+    this->posY[1] = new1Y;
+
+    this->posX[0] += middleX;
+    this->posX[1] += middleX;
+
+    this->posY[0] += middleY;
+    this->posY[1] += middleY;
+
+    this->updateGeometry();
+}
+
+template <typename Scalar>
+void BasicCapsule<Scalar>::updateGeometry()
+{
+    Scalar deltaX = this->posX[0] - this->posX[1];
+    Scalar deltaY = this->posY[0] - this->posY[1];
+
+    this->length = sqrt(deltaX * deltaX + deltaY * deltaY);
+
+    this->axisX = deltaX / this->length;
+    this->axisY = deltaY / this->length;
+
+    this->box = { min(this->posX[0], this->posX[1]) - this->radius, min(this->posY[0], this->posY[1]) - this->radius,
+        max(this->posX[0], this->posX[1]) + this->radius, max(this->posY[0], this->posY[1]) + this->radius };
+}
+
+template <typename Scalar>
+bool BasicCapsule<Scalar>::isMoving() const
+{
+    return this->speedX != 0 || this->speedY != 0 || this->angularSpeed != 0;
+}
+
+template <typename Scalar>
+void BasicCapsule<Scalar>::surfaceSpeed(Scalar x, Scalar y, Scalar& surfaceSpeedX, Scalar& surfaceSpeedY) const
+{
+    Scalar projection = (x - this->posX[1]) * this->axisX + (y - this->posY[1]) * this->axisY;
+
+    projection = min(max(projection, Scalar(0)), this->length);
+
+    // The nearest point's offset from the middle is along the axis; the rotation adds the perpendicular speed.
+    Scalar offset = projection - this->length / 2;
+
+    surfaceSpeedX = this->speedX - this->angularSpeed * offset * this->axisY;
+    surfaceSpeedY = this->speedY + this->angularSpeed * offset * this->axisX;
+}
+
+template <typename Scalar>
+Aabb<Scalar> BasicCapsule<Scalar>::sweptBox(Scalar deltaTime) const
+{
+    // The ends move by at most the translation plus the rotation's speed at the ends.
+    Scalar rotation = abs(this->angularSpeed) * this->length / 2 * deltaTime;
+
+    Scalar motionX = this->speedX * deltaTime;
+    Scalar motionY = this->speedY * deltaTime;
+
+    return { this->box.minX + min(motionX, Scalar(0)) - rotation, this->box.minY + min(motionY, Scalar(0)) - rotation,
+        this->box.maxX + max(motionX, Scalar(0)) + rotation, this->box.maxY + max(motionY, Scalar(0)) + rotation };
+}
+
+template <typename Scalar>
+void BasicCapsule<Scalar>::move(Scalar deltaTime)
+{
+    for (int k = 0; k < 2; k++)
+    {
+        this->posX[k] += this->speedX * deltaTime;
+        this->posY[k] += this->speedY * deltaTime;
+    }
+
+    if (this->angularSpeed != 0)
+        this->rotate(this->angularSpeed * deltaTime);
+}
+
+template <typename Scalar>
+BasicWorld<Scalar>::BasicWorld()
+{
+    this->width = WINDOW_WIDTH;
+    this->height = WINDOW_HEIGHT;
+
+    this->currentGravityX = 0;
+    this->currentGravityY = -Scalar(SCALAR_GRAVITY);
+
+    this->changeGravitySourceButtonPressed = false;
+    this->changedGravityActive = false;
+    this->gravitySource = INVALID_BODY_HANDLE;
+
+    this->numberOfSimulations = NUMBER_OF_SIMULATIONS;
+
+    this->adaptiveSubsteps = false;
+    this->substepSafetyFactor = Scalar(SUBSTEP_SAFETY_FACTOR);
+    this->minSubsteps = MIN_ADAPTIVE_SUBSTEPS;
+    this->maxSubsteps = MAX_ADAPTIVE_SUBSTEPS;
+
+    this->frameSubsteps = 0;
+
+    this->multirateStepping = false;
+    this->multirateLevels = 1;
+    this->multirateAwakeCircles = 0;
+    this->multirateSubstep = 0;
+    this->multirateCircleSteps = 0;
+    this->promotedCircles = 0;
+
+    this->continuousCollisions = false;
+    this->sweptCircles = 0;
+    this->timeOfImpactHits = 0;
+
+    this->movingCapsuleHits = 0;
+
+    this->simulationDeltaTime = 0;
+
+    this->frameIndex = 0;
+
+    this->circleBroadphase = CIRCLE_BROADPHASE_AUTO;
+    this->capsuleBroadphase = CAPSULE_BROADPHASE_AABB_TREE;
+
+    this->allPairsCrossover = ALL_PAIRS_CROSSOVER_PER_LANE * simdLanes<Scalar>();
+
+    this->circleVerlet.skin = Scalar(VERLET_SKIN);
+
+    this->bodiesVersion = 0;
+
+    this->reorderInterval = 0;
+
+    this->sleepingEnabled = false;
+    this->numAwakeCircles = 0;
+
+    this->contactSolver = CONTACT_SOLVER_PROJECTION;
+    this->contactIterations = CONTACT_ITERATIONS;
+    this->contactCompliance = Scalar(XPBD_CONTACT_COMPLIANCE);
+
+    this->contactParallelism = CONTACT_PARALLELISM_NONE;
+    this->contactThreads = (int)thread::hardware_concurrency();
+
+    this->inputRecorder = nullptr;
+    this->inputPlayer = nullptr;
+}
+
+template <typename Scalar>
+BodyHandle BasicWorld<Scalar>::addCircle(const BasicCircle<Scalar>& circle)
+{
+    this->circles.add(circle);
+
+    CircleColdData coldData;
+
+    coldData.red = circle.red;
+    coldData.green = circle.green;
+    coldData.blue = circle.blue;
+    coldData.restitution = circle.restitution;
+    coldData.playerControlled = circle.playerControlled;
+
+    this->circleColdData.push_back(coldData);
+    this->circleSleepTime.push_back(0);
+
+    BodyHandle handle = this->circleRegistry.create();
+
+    // New circles are awake, so they trade places with the first sleeping one.
+    int index = this->circles.size() - 1;
+
+    if (index != this->numAwakeCircles)
+        this->swapCircles(index, this->numAwakeCircles);
+
+    this->numAwakeCircles++;
+
+    this->bodiesVersion++;
+
+    return handle;
+}
+
+template <typename Scalar>
+BodyHandle BasicWorld<Scalar>::addCapsule(const BasicCapsule<Scalar>& capsule)
+{
+    this->capsules.push_back(capsule);
+
+    this->bodiesVersion++;
+
+    return this->capsuleRegistry.create();
+}
+
+template <typename Scalar>
+void BasicWorld<Scalar>::addCircles(const vector<BasicCircle<Scalar>>& newCircles, vector<BodyHandle>* handles)
+{
+    int capacity = this->circles.size() + (int)newCircles.size();
+
+    this->circles.reserve(capacity);
+    this->circleColdData.reserve(capacity);
+    this->circleSleepTime.reserve(capacity);
+    this->circleRegistry.reserve(capacity);
+
+    for (int i = 0; i < newCircles.size(); i++)
+    {
+        BodyHandle handle = this->addCircle(newCircles[i]);
+
+        if (handles != nullptr)
+            handles->push_back(handle);
+    }
+}
+
+template <typename Scalar>
+bool BasicWorld<Scalar>::removeCircle(BodyHandle handle)
+{
+    int removedIndex = this->circleRegistry.denseIndex(handle);
+
+    if (removedIndex == -1)
+        return false;
+
+    // An awake circle first trades places with the last awake one, so the swap-remove below only moves a sleeping
+    // circle (or none) and the awake prefix stays contiguous.
+    if (removedIndex < this->numAwakeCircles)
+    {
+        this->numAwakeCircles--;
+
+        if (removedIndex != this->numAwakeCircles)
+            this->swapCircles(removedIndex, this->numAwakeCircles);
+    }
+
+    removedIndex = this->circleRegistry.remove(handle);
+
+    this->circles.swapRemove(removedIndex);
+
+    this->circleColdData[removedIndex] = this->circleColdData.back();
+    this->circleColdData.pop_back();
+
+    this->circleSleepTime[removedIndex] = this->circleSleepTime.back();
+    this->circleSleepTime.pop_back();
+
+    this->bodiesVersion++;
+
+    return true;
+}
+
+template <typename Scalar>
+bool BasicWorld<Scalar>::removeCapsule(BodyHandle handle)
+{
+    int removedIndex = this->capsuleRegistry.remove(handle);
+
+    if (removedIndex == -1)
+        return false;
+
+    this->capsules[removedIndex] = this->capsules.back();
+    this->capsules.pop_back();
+
+    this->bodiesVersion++;
+
+    return true;
+}
+
+template <typename Scalar>
+int BasicWorld<Scalar>::removeCircles(const vector<BodyHandle>& handles)
+{
+    int removed = 0;
+
+    for (int i = 0; i < handles.size(); i++)
+    {
+        if (this->removeCircle(handles[i]))
+            removed++;
+    }
+
+    return removed;
+}
+
+template <typename Scalar>
+BasicCircle<Scalar> BasicWorld<Scalar>::getCircle(int i) const
+{
+    BasicCircle<Scalar> circle(this->circles.posX[i], this->circles.posY[i], this->circles.radius[i], this->circleColdData[i].red, this->circleColdData[i].green, this->circleColdData[i].blue, this->circles.mass[i], this->circles.speedX[i], this->circles.speedY[i]);
+
+    circle.restitution = this->circleColdData[i].restitution;
+    circle.playerControlled = this->circleColdData[i].playerControlled;
+
+    return circle;
+}
+
+template <typename Scalar>
+inline Aabb<Scalar> circleBox(Scalar posX, Scalar posY, Scalar extent)
+{
+    return { posX - extent, posY - extent, posX + extent, posY + extent };
+}
+
+// Interleaves the low 16 bits of x and y, x in the even bits.
+inline uint32_t mortonKey(uint32_t x, uint32_t y)
+{
+    uint32_t key = 0;
+
+    for (int bit = 0; bit < 16; bit++)
+    {
+        key |= ((x >> bit) & 1u) << (2 * bit);
+        key |= ((y >> bit) & 1u) << (2 * bit + 1);
+    }
+
+    return key;
+}
+
+template <typename Scalar>
+void BasicWorld<Scalar>::reorderCircles()
+{
+    int numCircles = this->circles.size();
+
+    const Scalar* posX = this->circles.posX.data();
+    const Scalar* posY = this->circles.posY.data();
+    const Scalar* radius = this->circles.radius.data();
+
+    Scalar maxRadius = 0;
+
+    for (int i = 0; i < numCircles; i++)
+        maxRadius = max(maxRadius, radius[i]);
+
+    // Cells one diameter wide, like the grid's, so a circle's neighbours share or nearly share its key.
+    double cellSize = max(2.0 * maxRadius, 1.0);
+
+    // Key in the high half, old index in the low half: a plain sort is then deterministic and stable.
+    vector<uint64_t> keys(numCircles);
+
+    for (int i = 0; i < numCircles; i++)
+    {
+        int cellX = (int)floor((posX[i] + this->width / 2) / cellSize);
+        int cellY = (int)floor((posY[i] + this->height / 2) / cellSize);
+
+        cellX = min(max(cellX, 0), 0xFFFF);
+        cellY = min(max(cellY, 0), 0xFFFF);
+
+        keys[i] = ((uint64_t)mortonKey(cellX, cellY) << 32) | (uint32_t)i;
+    }
+
+    // Awake and sleeping circles are sorted separately, so the awake prefix stays in front.
+    sort(keys.begin(), keys.begin() + this->numAwakeCircles);
+    sort(keys.begin() + this->numAwakeCircles, keys.end());
+
+    vector<int> order(numCircles);
+
+    bool unchanged = true;
+
+    for (int n = 0; n < numCircles; n++)
+    {
+        order[n] = (int)(keys[n] & 0xFFFFFFFFu);
+
+        if (order[n] != n)
+            unchanged = false;
+    }
+
+    if (unchanged)
+        return;
+
+    this->permuteCircles(order);
+}
+
+template <typename Scalar>
+void BasicWorld<Scalar>::permuteCircles(const vector<int>& order)
+{
+    int numCircles = this->circles.size();
+
+    this->circles.permute(order);
+
+    vector<CircleColdData> oldColdData = this->circleColdData;
+
+    for (int n = 0; n < numCircles; n++)
+        this->circleColdData[n] = oldColdData[order[n]];
+
+    vector<Scalar> oldSleepTime = this->circleSleepTime;
+
+    for (int n = 0; n < numCircles; n++)
+        this->circleSleepTime[n] = oldSleepTime[order[n]];
+
+    this->circleRegistry.permute(order);
+
+    this->bodiesVersion++;
+}
+
+template <typename Scalar>
+void BasicWorld<Scalar>::swapCircles(int a, int b)
+{
+    this->circles.swap(a, b);
+
+    swap(this->circleColdData[a], this->circleColdData[b]);
+    swap(this->circleSleepTime[a], this->circleSleepTime[b]);
+
+    this->circleRegistry.swap(a, b);
+}
+
+template <typename Scalar>
+void BasicWorld<Scalar>::wakeCircles()
+{
+    vector<int>& circlesToWake = this->circlesToWake;
+
+    sort(circlesToWake.begin(), circlesToWake.end());
+    circlesToWake.erase(unique(circlesToWake.begin(), circlesToWake.end()), circlesToWake.end());
+
+    // In increasing order, each circle trades places with the first sleeping one, which is never a circle still to
+    // be woken, so the indices left in the list stay valid.
+    for (int k = 0; k < circlesToWake.size(); k++)
+    {
+        int i = circlesToWake[k];
+
+        if (i < this->numAwakeCircles)
+            continue;
+
+        if (i != this->numAwakeCircles)
+            this->swapCircles(i, this->numAwakeCircles);
+
+        this->circleSleepTime[this->numAwakeCircles] = 0;
+        this->numAwakeCircles++;
+    }
+
+    circlesToWake.clear();
+
+    this->bodiesVersion++;
+}
+
+template <typename Scalar>
+void BasicWorld<Scalar>::wakeAllCircles()
+{
+    // Nothing moves, so the broadphases stay valid.
+    for (int i = this->numAwakeCircles; i < this->circles.size(); i++)
+        this->circleSleepTime[i] = 0;
+
+    this->numAwakeCircles = this->circles.size();
+    this->circlesToWake.clear();
+}
+
+template <typename Scalar>
+void BasicWorld<Scalar>::updateSleeping(Scalar frameDeltaTime)
+{
+    int numCircles = this->circles.size();
+
+    if (!this->sleepingEnabled || this->changedGravityActive)
+    {
+        if (this->numAwakeCircles < numCircles)
+            this->wakeAllCircles();
+
+        return;
+    }
+
+    int numAwake = this->numAwakeCircles;
+
+    const Scalar* posX = this->circles.posX.data();
+    const Scalar* posY = this->circles.posY.data();
+    Scalar* speedX = this->circles.speedX.data();
+    Scalar* speedY = this->circles.speedY.data();
+    const Scalar* radius = this->circles.radius.data();
+
+    Scalar* sleepTime = this->circleSleepTime.data();
+
+    Scalar sleepSpeedSquared = Scalar(SLEEP_SPEED) * Scalar(SLEEP_SPEED);
+
+    bool anyReady = false;
+    Scalar maxRadius = 0;
+
+    for (int i = 0; i < numAwake; i++)
+    {
+        if (speedX[i] * speedX[i] + speedY[i] * speedY[i] < sleepSpeedSquared)
+            sleepTime[i] += frameDeltaTime;
+        else
+            sleepTime[i] = 0;
+
+        if (sleepTime[i] >= Scalar(SLEEP_TIME))
+            anyReady = true;
+
+        maxRadius = max(maxRadius, radius[i]);
+    }
+
+    if (!anyReady)
+        return;
+
+    // Islands of touching awake circles, found on a grid of the awake prefix; sleeping circles are static and do
+    // not join islands. The grid is rebuilt by every pass that uses it, so it is free to borrow here.
+    Scalar slop = Scalar(SLEEP_CONTACT_SLOP);
+
+    this->circleIslands.reset(numAwake);
+
+    // Circles of zero radius never rest on each other, so each is its own island.
+    if (maxRadius > 0)
+    {
+        this->circleGrid.build(posX, posY, radius, numAwake, this->width, this->height, slop / (2 * maxRadius));
+
+        vector<int>& neighbours = this->circleNeighbours;
+
+        for (int i = 0; i < numAwake; i++)
+        {
+            neighbours.clear();
+            this->circleGrid.queryNeighbours(i, neighbours);
+
+            for (int k = 0; k < neighbours.size(); k++)
+            {
+                int j = neighbours[k];
+
+                Scalar deltaX = posX[j] - posX[i];
+                Scalar deltaY = posY[j] - posY[i];
+
+                Scalar contactDist = radius[i] + radius[j] + slop;
+
+                if (deltaX * deltaX + deltaY * deltaY < contactDist * contactDist)
+                    this->circleIslands.unite(i, j);
+            }
+        }
+    }
+
+    this->circleIslandReady.assign(numAwake, 1);
+
+    for (int i = 0; i < numAwake; i++)
+    {
+        if (sleepTime[i] < Scalar(SLEEP_TIME))
+            this->circleIslandReady[this->circleIslands.find(i)] = 0;
+    }
+
+    // From the back, so a circle put to sleep trades places with one that has already been decided on.
+    bool anySlept = false;
+
+    for (int i = numAwake - 1; i >= 0; i--)
+    {
+        if (!this->circleIslandReady[this->circleIslands.find(i)])
+            continue;
+
+        speedX[i] = 0;
+        speedY[i] = 0;
+
+        this->numAwakeCircles--;
+
+        if (i != this->numAwakeCircles)
+            this->swapCircles(i, this->numAwakeCircles);
+
+        anySlept = true;
+    }
+
+    if (anySlept)
+        this->bodiesVersion++;
+}
+
+template <typename Scalar>
+void BasicWorld<Scalar>::handleInput(const InputState& input)
+{
+    int numCircles = this->circles.size();
+
+    Scalar* posX = this->circles.posX.data();
+    Scalar* posY = this->circles.posY.data();
+    Scalar* speedX = this->circles.speedX.data();
+    Scalar* speedY = this->circles.speedY.data();
+    const Scalar* radius = this->circles.radius.data();
+
+    vector<BasicCapsule<Scalar>>& capsules = this->capsules;
+
+    Scalar simulationDeltaTime = this->simulationDeltaTime;
+
+    Scalar playerImpulseX = 1000;
+    Scalar playerImpulseY = 1000;
+    Scalar explosionImpulse = 300000;
+
+    Scalar playerTranslationX = 300;
+    Scalar playerTranslationY = 300;
+
+    Scalar playerAngle = 5;
+
+    if (this->numAwakeCircles < numCircles)
+    {
+        // The explosion and a gravity change reach every circle; arrow keys only the player circle. With
+        // multirateStepping the circles are left in circlesToWake, for simulate to promote once the substep's levels
+        // are known.
+        if (input.keyB || input.keyG)
+        {
+            if (this->multirateStepping)
+            {
+                for (int i = this->numAwakeCircles; i < numCircles; i++)
+                    this->circlesToWake.push_back(i);
+            }
+            else
+                this->wakeAllCircles();
+        }
+        else if (input.keyUp || input.keyDown || input.keyLeft || input.keyRight)
+        {
+            for (int i = this->numAwakeCircles; i < numCircles; i++)
+            {
+                if (this->circleColdData[i].playerControlled)
+                    this->circlesToWake.push_back(i);
+            }
+
+            if (!this->circlesToWake.empty() && !this->multirateStepping)
+                this->wakeCircles();
+        }
+    }
+
+    for (int i = 0; i < numCircles; i++)
+    {
+        if (this->circleColdData[i].playerControlled)
+        {
+            if (input.keyUp)
+                speedY[i] += playerImpulseY * simulationDeltaTime;
+            if (input.keyDown)
+                speedY[i] -= playerImpulseY * simulationDeltaTime;
+            if (input.keyLeft)
+                speedX[i] -= playerImpulseX * simulationDeltaTime;
+            if (input.keyRight)
+                speedX[i] += playerImpulseX * simulationDeltaTime;
+
+            if (input.keyB)
+            {
+                for (int j = 0; j < numCircles; j++)
+                {
+                    if (i == j) continue;
+
+                    Scalar deltaX = posX[j] - posX[i];
+                    Scalar deltaY = posY[j] - posY[i];
+
+                    Scalar centersDist = sqrt(deltaX * deltaX + deltaY * deltaY);
+
+                    speedX[j] += deltaX / centersDist * explosionImpulse / centersDist * simulationDeltaTime;
+                    speedY[j] += deltaY / centersDist * explosionImpulse / centersDist * simulationDeltaTime;
+                }
+            }
+            if (input.keyG)
+            {
+                if (!this->changeGravitySourceButtonPressed)
+                {
+                    this->changeGravitySourceButtonPressed = true;
+
+                    if (this->changedGravityActive)
+                    {
+                        this->changedGravityActive = false;
+                        this->currentGravityX = 0;
+                        this->currentGravityY = -Scalar(SCALAR_GRAVITY);
+                    }
+                    else
+                    {
+                        this->changedGravityActive = true;
+                        this->gravitySource = this->circleRegistry.handleAt(i);
+                    }
+                }
+            }
+            else
+            {
+                this->changeGravitySourceButtonPressed = false;
+            }
+        }
+    }
+
+    for (int j = 0; j < capsules.size(); j++)
+    {
+        if (capsules[j].playerControlled)
+        {
+            // Kinematic: the keys set the velocity and the capsule moves with the circles in updateCapsulesStatuses.
+            capsules[j].speedX = 0;
+            capsules[j].speedY = 0;
+            capsules[j].angularSpeed = 0;
+
+            if (input.keyW)
+                capsules[j].speedY += playerTranslationY;
+            if (input.keyS)
+                capsules[j].speedY -= playerTranslationY;
+            if (input.keyA)
+                capsules[j].speedX -= playerTranslationX;
+            if (input.keyD)
+                capsules[j].speedX += playerTranslationX;
+            if (input.keyQ)
+                capsules[j].angularSpeed += playerAngle;
+            if (input.keyE)
+                capsules[j].angularSpeed -= playerAngle;
+        }
+
+        if (this->numAwakeCircles < numCircles && capsules[j].isMoving())
+        {
+            // Sleeping circles ignore capsules, so the ones the moving capsule may touch during the substep are woken first.
+            Aabb<Scalar> box = capsules[j].sweptBox(simulationDeltaTime);
+
+            for (int i = this->numAwakeCircles; i < numCircles; i++)
+            {
+                if (box.overlaps(circleBox(posX[i], posY[i], radius[i])))
+                    this->circlesToWake.push_back(i);
+            }
+        }
+    }
+
+    if (!this->circlesToWake.empty() && !this->multirateStepping)
+        this->wakeCircles();
+}
+
+template <typename Scalar>
+void BasicWorld<Scalar>::handleCollisions()
+{
+    if (this->contactSolver == CONTACT_SOLVER_IMPULSES)
+    {
+        this->handleCollisionsImpulses();
+        return;
+    }
+
+    if (this->contactSolver == CONTACT_SOLVER_XPBD)
+    {
+        this->handleCollisionsXpbd();
+        return;
+    }
+
+    this->handleWallCollisions();
+
+    this->handleCircleCollisions();
+
+    this->handleCapsuleCollisions();
+}
+
+template <typename Scalar>
+template <typename AddContact>
+void BasicWorld<Scalar>::findContacts(const AddContact& addContact, Scalar margin)
+{
+    int numCircles = this->circles.size();
+    int numAwake = this->numAwakeCircles;
+    int numCapsules = (int)this->capsules.size();
+
+    const Scalar* posX = this->circles.posX.data();
+    const Scalar* posY = this->circles.posY.data();
+    Scalar* speedX = this->circles.speedX.data();
+    Scalar* speedY = this->circles.speedY.data();
+    const Scalar* radius = this->circles.radius.data();
+
+    Scalar maxRadius = 0;
+
+    for (int i = 0; i < numCircles; i++)
+        maxRadius = max(maxRadius, radius[i]);
+
+    // The cells also cover the margin, so pairs that are still apart are found too. Circles of zero radius never
+    // touch, so they are searched without it.
+    {
+        TRACE_SCOPE("buildGrid");
+        this->circleGrid.build(posX, posY, radius, numCircles, this->width, this->height, Scalar(GRID_CELL_MARGIN) + (maxRadius > 0 ? margin / (2 * maxRadius) : Scalar(0)));
+    }
+
+    Scalar halfWidth = this->width / 2;
+    Scalar halfHeight = this->height / 2;
+
+    Scalar floorDamping = 1 - Scalar(FRICTION) * this->simulationDeltaTime;
+
+    vector<int>& neighbours = this->circleNeighbours;
+
+    // Keys: the four walls, then the capsules, then the circles, so they increase in the order each circle's contacts are added.
+    int firstCircleKey = 4 + numCapsules;
+
+    {
+        TRACE_SCOPE("findContacts");
+
+        for (int a = 0; a < numAwake; a++)
+        {
+            Scalar restitutionA = Scalar(this->circleColdData[a].restitution);
+
+            Scalar leftSeparation = posX[a] - radius[a] + halfWidth;
+            Scalar rightSeparation = halfWidth - posX[a] - radius[a];
+            Scalar floorSeparation = posY[a] - radius[a] + halfHeight;
+            Scalar ceilingSeparation = halfHeight - posY[a] - radius[a];
+
+            if (leftSeparation < margin)
+                addContact(a, -1, 0, 1, 0, leftSeparation, 0, restitutionA);
+            if (rightSeparation < margin)
+                addContact(a, -1, 1, -1, 0, rightSeparation, 0, restitutionA);
+            if (floorSeparation < margin)
+            {
+                addContact(a, -1, 2, 0, 1, floorSeparation, 0, restitutionA);
+                speedX[a] *= floorDamping;
+            }
+            if (ceilingSeparation < margin)
+                addContact(a, -1, 3, 0, -1, ceilingSeparation, 0, restitutionA);
+
+            for (int j = 0; j < numCapsules; j++)
+            {
+                const BasicCapsule<Scalar>& capsule = this->capsules[j];
+
+                if (posX[a] + radius[a] < capsule.box.minX || posX[a] - radius[a] > capsule.box.maxX || posY[a] + radius[a] < capsule.box.minY || posY[a] - radius[a] > capsule.box.maxY)
+                    continue;
+
+                Scalar projection = (posX[a] - capsule.posX[1]) * capsule.axisX + (posY[a] - capsule.posY[1]) * capsule.axisY;
+
+                projection = min(max(projection, Scalar(0)), capsule.length);
+
+                Scalar deltaX = posX[a] - (capsule.posX[1] + capsule.axisX * projection);
+                Scalar deltaY = posY[a] - (capsule.posY[1] + capsule.axisY * projection);
+
+                Scalar contactDist = radius[a] + capsule.radius;
+
+                if (deltaX * deltaX + deltaY * deltaY >= (contactDist + margin) * (contactDist + margin))
+                    continue;
+
+                Scalar dist = sqrt(deltaX * deltaX + deltaY * deltaY);
+
+                if (dist <= 0)
+                    continue;
+
+                Scalar normalX = deltaX / dist;
+                Scalar normalY = deltaY / dist;
+
+                Scalar surfaceSpeedX;
+                Scalar surfaceSpeedY;
+
+                capsule.surfaceSpeed(posX[a], posY[a], surfaceSpeedX, surfaceSpeedY);
+
+                addContact(a, -1, 4 + j, normalX, normalY, dist - contactDist, surfaceSpeedX * normalX + surfaceSpeedY * normalY, restitutionA);
+            }
+
+            neighbours.clear();
+            this->circleGrid.queryNeighbours(a, neighbours);
+
+            for (int k = 0; k < neighbours.size(); k++)
+            {
+                int b = neighbours[k];
+
+                Scalar deltaX = posX[a] - posX[b];
+                Scalar deltaY = posY[a] - posY[b];
+
+                Scalar contactDist = radius[a] + radius[b];
+
+                if (deltaX * deltaX + deltaY * deltaY >= (contactDist + margin) * (contactDist + margin))
+                    continue;
+
+                Scalar dist = sqrt(deltaX * deltaX + deltaY * deltaY);
+
+                // Circles on top of each other are pulled apart vertically.
+                Scalar normalX = dist > 0 ? deltaX / dist : Scalar(0);
+                Scalar normalY = dist > 0 ? deltaY / dist : Scalar(1);
+
+                // A sleeping circle is static to the solver, and woken by a fast enough approach.
+                if (b >= numAwake && -(speedX[a] * normalX + speedY[a] * normalY) > Scalar(SLEEP_SPEED))
+                    this->circlesToWake.push_back(b);
+
+                Scalar restitution = Scalar(max(this->circleColdData[a].restitution, this->circleColdData[b].restitution));
+
+                addContact(a, b, firstCircleKey + b, normalX, normalY, dist - contactDist, 0, restitution);
+            }
+        }
+    }
+}
+
+template <typename Scalar>
+void BasicWorld<Scalar>::handleCollisionsImpulses()
+{
+    ImpulseSolver<Scalar>& solver = this->impulseSolver;
+
+    solver.beginContacts(this->bodiesVersion);
+
+    if (this->numAwakeCircles == 0)
+        return;
+
+    this->findContacts([&](int a, int b, int key, Scalar normalX, Scalar normalY, Scalar separation, Scalar surfaceSpeed, Scalar restitution)
+    {
+        solver.addContact(a, b, key, normalX, normalY, separation, surfaceSpeed, restitution);
+    }, Scalar(0));
+
+    {
+        TRACE_SCOPE("solveContacts");
+        solver.solve(this->circles.posX.data(), this->circles.posY.data(), this->circles.speedX.data(), this->circles.speedY.data(), this->circles.mass.data(), this->numAwakeCircles, this->simulationDeltaTime, this->contactIterations);
+    }
+}
+
+template <typename Scalar>
+void BasicWorld<Scalar>::handleCollisionsXpbd()
+{
+    XpbdSolver<Scalar>& solver = this->xpbdSolver;
+
+    solver.clear();
+
+    if (this->numAwakeCircles == 0)
+        return;
+
+    // XPBD keeps nothing from one substep to the next, so it has no use for the keys.
+    this->findContacts([&](int a, int b, int, Scalar normalX, Scalar normalY, Scalar separation, Scalar surfaceSpeed, Scalar restitution)
+    {
+        solver.addContact(a, b, normalX, normalY, separation, surfaceSpeed, restitution);
+    }, Scalar(XPBD_CONTACT_MARGIN));
+
+    // Circles of coarser levels moved by their own, longer step.
+    const Scalar* stepMultiplier = this->levelStepMultipliers();
+
+    {
+        TRACE_SCOPE("solveContacts");
+        solver.solve(this->circles.posX.data(), this->circles.posY.data(), this->circles.speedX.data(), this->circles.speedY.data(), this->circles.mass.data(), this->numAwakeCircles, this->simulationDeltaTime, this->contactIterations, this->contactCompliance, stepMultiplier);
+    }
+}
+
+template <typename Scalar>
+void BasicWorld<Scalar>::handleWallCollisions()
+{
+    // Sleeping circles rest inside the box.
+    int numAwake = this->numAwakeCircles;
+
+    Scalar* posX = this->circles.posX.data();
+    Scalar* posY = this->circles.posY.data();
+    Scalar* speedX = this->circles.speedX.data();
+    Scalar* speedY = this->circles.speedY.data();
+    const Scalar* radius = this->circles.radius.data();
+
+    Scalar simulationDeltaTime = this->simulationDeltaTime;
+
+    Scalar halfWidth = this->width / 2;
+    Scalar halfHeight = this->height / 2;
+
+    for (int i = 0; i < numAwake; i++)
+    {
+        if (posX[i] - radius[i] < -halfWidth)
+        {
+            posX[i] += -halfWidth - (posX[i] - radius[i]);
+            speedX[i] = -speedX[i];
+        }
+        if (posX[i] + radius[i] > halfWidth)
+        {
+            posX[i] -= posX[i] + radius[i] - halfWidth;
+            speedX[i] = -speedX[i];
+        }
+        if (posY[i] - radius[i] < -halfHeight)
+        {
+            posY[i] += -halfHeight - (posY[i] - radius[i]);
+            speedY[i] = -speedY[i];
+            speedX[i] *= 1 - Scalar(FRICTION) * simulationDeltaTime;
+        }
+        if (posY[i] + radius[i] > halfHeight)
+        {
+            posY[i] -= posY[i] + radius[i] - halfHeight;
+            speedY[i] = -speedY[i];
+        }
+    }
+}
+
+// Elastic response between circle i, held in locals by the caller, and circle j if they overlap.
+template <typename Scalar>
+inline void collideCircles(Scalar& posXI, Scalar& posYI, Scalar& speedXI, Scalar& speedYI, Scalar radiusI, Scalar massI,
+    Scalar* posX, Scalar* posY, Scalar* speedX, Scalar* speedY, const Scalar* radius, const Scalar* mass, int j)
+{
+    Scalar deltaX = posXI - posX[j];
+    Scalar deltaY = posYI - posY[j];
+
+    if (deltaX * deltaX + deltaY * deltaY < (radiusI + radius[j]) * (radiusI + radius[j]))
+    {
+        Scalar centersDist = sqrt(deltaX * deltaX + deltaY * deltaY);
+
+        Scalar normDeltaX = deltaX / centersDist;
+        Scalar normDeltaY = deltaY / centersDist;
+
+        Scalar overlapDist = radiusI + radius[j] - centersDist;
+
+        posXI += normDeltaX * overlapDist / 2;
+        posYI += normDeltaY * overlapDist / 2;
+
+        posX[j] -= normDeltaX * overlapDist / 2;
+        posY[j] -= normDeltaY * overlapDist / 2;
+
+        Scalar collisionInitialSpeedI = speedXI * normDeltaX + speedYI * normDeltaY;
+        Scalar collisionInitialSpeedJ = speedX[j] * normDeltaX + speedY[j] * normDeltaY;
+
+        Scalar collisionFinalSpeedI = (massI - mass[j]) / (massI + mass[j]) * collisionInitialSpeedI + 2 * mass[j] / (massI + mass[j]) * collisionInitialSpeedJ;
+        Scalar collisionFinalSpeedJ = 2 * massI / (massI + mass[j]) * collisionInitialSpeedI + (mass[j] - massI) / (massI + mass[j]) * collisionInitialSpeedJ;
+
+        speedXI -= normDeltaX * collisionInitialSpeedI;
+        speedYI -= normDeltaY * collisionInitialSpeedI;
+
+        speedX[j] -= normDeltaX * collisionInitialSpeedJ;
+        speedY[j] -= normDeltaY * collisionInitialSpeedJ;
+
+        speedXI += normDeltaX * collisionFinalSpeedI;
+        speedYI += normDeltaY * collisionFinalSpeedI;
+
+        speedX[j] += normDeltaX * collisionFinalSpeedJ;
+        speedY[j] += normDeltaY * collisionFinalSpeedJ;
+    }
+}
+
+// Circle i, held in locals by the caller, against sleeping circle j, which does not move: circle i is pushed out by
+// the whole overlap and the normal part of its velocity is reflected. Returns whether the contact closed faster than
+// SLEEP_SPEED, in which case circle j should be woken.
+template <typename Scalar>
+inline bool collideSleepingCircle(Scalar& posXI, Scalar& posYI, Scalar& speedXI, Scalar& speedYI, Scalar radiusI,
+    const Scalar* posX, const Scalar* posY, const Scalar* radius, int j)
+{
+    Scalar deltaX = posXI - posX[j];
+    Scalar deltaY = posYI - posY[j];
+
+    if (deltaX * deltaX + deltaY * deltaY >= (radiusI + radius[j]) * (radiusI + radius[j]))
+        return false;
+
+    Scalar centersDist = sqrt(deltaX * deltaX + deltaY * deltaY);
+
+    Scalar normDeltaX = deltaX / centersDist;
+    Scalar normDeltaY = deltaY / centersDist;
+
+    Scalar overlapDist = radiusI + radius[j] - centersDist;
+
+    posXI += normDeltaX * overlapDist;
+    posYI += normDeltaY * overlapDist;
+
+    Scalar normalSpeed = speedXI * normDeltaX + speedYI * normDeltaY;
+
+    if (normalSpeed < 0)
+    {
+        speedXI -= 2 * normDeltaX * normalSpeed;
+        speedYI -= 2 * normDeltaY * normalSpeed;
+    }
+
+    return -normalSpeed > Scalar(SLEEP_SPEED);
+}
+
+template <typename Scalar>
+void BasicWorld<Scalar>::handleCircleCollisions()
+{
+    // Sleeping circles never touch each other, so with every circle asleep not even the broadphase has to run.
+    if (this->numAwakeCircles == 0)
+        return;
+
+    if (this->contactParallelism == CONTACT_PARALLELISM_COLORED)
+        this->handleCircleCollisionsColored();
+    else if (this->contactParallelism == CONTACT_PARALLELISM_ISLANDS)
+        this->handleCircleCollisionsIslands();
+    else if (this->circleBroadphase == CIRCLE_BROADPHASE_GRID)
+        this->handleCircleCollisionsGrid();
+    else if (this->circleBroadphase == CIRCLE_BROADPHASE_SWEEP_AND_PRUNE)
+        this->handleCircleCollisionsSweep();
+    else if (this->circleBroadphase == CIRCLE_BROADPHASE_AABB_TREE)
+        this->handleCircleCollisionsTree();
+    else if (this->circleBroadphase == CIRCLE_BROADPHASE_VERLET)
+        this->handleCircleCollisionsVerlet();
+    else if (this->circleBroadphase == CIRCLE_BROADPHASE_HIERARCHICAL_GRID)
+        this->handleCircleCollisionsHierarchicalGrid();
+    else if (this->circleBroadphase == CIRCLE_BROADPHASE_AUTO && this->circles.size() > this->allPairsCrossover)
+        this->handleCircleCollisionsGrid();
+    else
+        this->handleCircleCollisionsAllPairs();
+}
+
+template <typename Scalar>
+void BasicWorld<Scalar>::handleCircleCollisionsAllPairs()
+{
+    int numCircles = this->circles.size();
+    int numAwake = this->numAwakeCircles;
+
+    Scalar* posX = this->circles.posX.data();
+    Scalar* posY = this->circles.posY.data();
+    Scalar* speedX = this->circles.speedX.data();
+    Scalar* speedY = this->circles.speedY.data();
+    const Scalar* radius = this->circles.radius.data();
+    const Scalar* mass = this->circles.mass.data();
+
+    for (int i = 0; i < numAwake; i++)
+    {
+        // Circle i stays in registers for the whole inner loop; j > i never aliases it.
+        Scalar posXI = posX[i];
+        Scalar posYI = posY[i];
+        Scalar speedXI = speedX[i];
+        Scalar speedYI = speedY[i];
+        Scalar radiusI = radius[i];
+        Scalar massI = mass[i];
+
+        // The overlap tests run a vector of circles at a time; only the hits are resolved, one by one in j order.
+        int j = findFirstCircleOverlap(posXI, posYI, radiusI, posX, posY, radius, i + 1, numAwake);
+
+        while (j < numAwake)
+        {
+            collideCircles(posXI, posYI, speedXI, speedYI, radiusI, massI, posX, posY, speedX, speedY, radius, mass, j);
+
+            j = findFirstCircleOverlap(posXI, posYI, radiusI, posX, posY, radius, j + 1, numAwake);
+        }
+
+        // Sleeping circles come last and only push circle i back.
+        j = findFirstCircleOverlap(posXI, posYI, radiusI, posX, posY, radius, numAwake, numCircles);
+
+        while (j < numCircles)
+        {
+            if (collideSleepingCircle(posXI, posYI, speedXI, speedYI, radiusI, posX, posY, radius, j))
+                this->circlesToWake.push_back(j);
+
+            j = findFirstCircleOverlap(posXI, posYI, radiusI, posX, posY, radius, j + 1, numCircles);
+        }
+
+        posX[i] = posXI;
+        posY[i] = posYI;
+        speedX[i] = speedXI;
+        speedY[i] = speedYI;
+    }
+}
+
+template <typename Scalar>
+void BasicWorld<Scalar>::handleCircleCollisionsGrid()
+{
+    int numCircles = this->circles.size();
+    int numAwake = this->numAwakeCircles;
+
+    Scalar* posX = this->circles.posX.data();
+    Scalar* posY = this->circles.posY.data();
+    Scalar* speedX = this->circles.speedX.data();
+    Scalar* speedY = this->circles.speedY.data();
+    const Scalar* radius = this->circles.radius.data();
+    const Scalar* mass = this->circles.mass.data();
+
+    {
+        TRACE_SCOPE("buildGrid");
+        this->circleGrid.build(posX, posY, radius, numCircles, this->width, this->height, Scalar(GRID_CELL_MARGIN));
+    }
+
+    vector<int>& neighbours = this->circleNeighbours;
+
+    // Same visiting order as the all-pairs loop (i ascending, then j ascending), restricted to the grid's candidates.
+    for (int i = 0; i < numAwake; i++)
+    {
+        neighbours.clear();
+        this->circleGrid.queryNeighbours(i, neighbours);
+
+        Scalar posXI = posX[i];
+        Scalar posYI = posY[i];
+        Scalar speedXI = speedX[i];
+        Scalar speedYI = speedY[i];
+        Scalar radiusI = radius[i];
+        Scalar massI = mass[i];
+
+        int k = 0;
+
+        for (; k < neighbours.size() && neighbours[k] < numAwake; k++)
+            collideCircles(posXI, posYI, speedXI, speedYI, radiusI, massI, posX, posY, speedX, speedY, radius, mass, neighbours[k]);
+
+        for (; k < neighbours.size(); k++)
+        {
+            if (collideSleepingCircle(posXI, posYI, speedXI, speedYI, radiusI, posX, posY, radius, neighbours[k]))
+                this->circlesToWake.push_back(neighbours[k]);
+        }
+
+        posX[i] = posXI;
+        posY[i] = posYI;
+        speedX[i] = speedXI;
+        speedY[i] = speedYI;
+    }
+}
+
+template <typename Scalar>
+void BasicWorld<Scalar>::handleCircleCollisionsSweep()
+{
+    int numCircles = this->circles.size();
+    int numAwake = this->numAwakeCircles;
+
+    Scalar* posX = this->circles.posX.data();
+    Scalar* posY = this->circles.posY.data();
+    Scalar* speedX = this->circles.speedX.data();
+    Scalar* speedY = this->circles.speedY.data();
+    const Scalar* radius = this->circles.radius.data();
+    const Scalar* mass = this->circles.mass.data();
+
+    {
+        TRACE_SCOPE("updateSweep");
+        this->circleSweep.update(posX, posY, radius, numCircles, this->capsules.data(), (int)this->capsules.size(), Scalar(SWEEP_MARGIN), this->bodiesVersion);
+    }
+
+    for (int i = 0; i < numAwake; i++)
+    {
+        // Partners are sorted, and capsule ids come after every circle id.
+        const vector<int>& partners = this->circleSweep.partners[i];
+
+        Scalar posXI = posX[i];
+        Scalar posYI = posY[i];
+        Scalar speedXI = speedX[i];
+        Scalar speedYI = speedY[i];
+        Scalar radiusI = radius[i];
+        Scalar massI = mass[i];
+
+        int k = 0;
+
+        for (; k < partners.size() && partners[k] < numAwake; k++)
+            collideCircles(posXI, posYI, speedXI, speedYI, radiusI, massI, posX, posY, speedX, speedY, radius, mass, partners[k]);
+
+        for (; k < partners.size() && partners[k] < numCircles; k++)
+        {
+            if (collideSleepingCircle(posXI, posYI, speedXI, speedYI, radiusI, posX, posY, radius, partners[k]))
+                this->circlesToWake.push_back(partners[k]);
+        }
+
+        posX[i] = posXI;
+        posY[i] = posYI;
+        speedX[i] = speedXI;
+        speedY[i] = speedYI;
+    }
+}
+
+template <typename Scalar>
+void BasicWorld<Scalar>::updateCircleTree()
+{
+    int numCircles = this->circles.size();
+
+    const Scalar* posX = this->circles.posX.data();
+    const Scalar* posY = this->circles.posY.data();
+    const Scalar* radius = this->circles.radius.data();
+
+    if (this->circleTree.bodiesVersion != this->bodiesVersion)
+    {
+        this->circleTree.clear();
+        this->circleTree.bodiesVersion = this->bodiesVersion;
+
+        this->circleProxies.resize(numCircles);
+
+        for (int i = 0; i < numCircles; i++)
+            this->circleProxies[i] = this->circleTree.createProxy(circleBox(posX[i], posY[i], radius[i]), radius[i] * Scalar(AABB_TREE_FAT_MARGIN), i);
+
+        return;
+    }
+
+    // Sleeping circles do not move.
+    for (int i = 0; i < this->numAwakeCircles; i++)
+        this->circleTree.moveProxy(this->circleProxies[i], circleBox(posX[i], posY[i], radius[i]), radius[i] * Scalar(AABB_TREE_FAT_MARGIN));
+}
+
+template <typename Scalar>
+void BasicWorld<Scalar>::updateCapsuleTree()
+{
+    if (this->capsuleTree.bodiesVersion == this->bodiesVersion)
+        return;
+
+    this->capsuleTree.clear();
+    this->capsuleTree.bodiesVersion = this->bodiesVersion;
+
+    this->capsuleProxies.resize(this->capsules.size());
+
+    for (int j = 0; j < this->capsules.size(); j++)
+        this->capsuleProxies[j] = this->capsuleTree.createProxy(this->capsules[j].box, this->capsules[j].radius * Scalar(AABB_TREE_FAT_MARGIN), j);
+}
+
+template <typename Scalar>
+void BasicWorld<Scalar>::refitCapsule(int j)
+{
+    this->capsules[j].updateGeometry();
+
+    // A stale tree is rebuilt from scratch by the next capsule pass anyway.
+    if (this->capsuleTree.bodiesVersion != this->bodiesVersion)
+        return;
+
+    this->capsuleTree.moveProxy(this->capsuleProxies[j], this->capsules[j].box, this->capsules[j].radius * Scalar(AABB_TREE_FAT_MARGIN));
+}
+
+template <typename Scalar>
+void BasicWorld<Scalar>::handleCircleCollisionsTree()
+{
+    int numAwake = this->numAwakeCircles;
+
+    Scalar* posX = this->circles.posX.data();
+    Scalar* posY = this->circles.posY.data();
+    Scalar* speedX = this->circles.speedX.data();
+    Scalar* speedY = this->circles.speedY.data();
+    const Scalar* radius = this->circles.radius.data();
+    const Scalar* mass = this->circles.mass.data();
+
+    {
+        TRACE_SCOPE("updateCircleTree");
+        this->updateCircleTree();
+    }
+
+    vector<int>& neighbours = this->circleNeighbours;
+
+    for (int i = 0; i < numAwake; i++)
+    {
+        neighbours.clear();
+        this->circleTree.query(circleBox(posX[i], posY[i], radius[i] * (1 + Scalar(AABB_TREE_QUERY_MARGIN))), neighbours);
+
+        // Keep the candidates above i, in increasing order, like the all-pairs loop.
+        int numNeighbours = 0;
+
+        for (int k = 0; k < neighbours.size(); k++)
+        {
+            if (neighbours[k] > i)
+                neighbours[numNeighbours++] = neighbours[k];
+        }
+
+        neighbours.resize(numNeighbours);
+        sort(neighbours.begin(), neighbours.end());
+
+        Scalar posXI = posX[i];
+        Scalar posYI = posY[i];
+        Scalar speedXI = speedX[i];
+        Scalar speedYI = speedY[i];
+        Scalar radiusI = radius[i];
+        Scalar massI = mass[i];
+
+        int k = 0;
+
+        for (; k < neighbours.size() && neighbours[k] < numAwake; k++)
+            collideCircles(posXI, posYI, speedXI, speedYI, radiusI, massI, posX, posY, speedX, speedY, radius, mass, neighbours[k]);
+
+        for (; k < neighbours.size(); k++)
+        {
+            if (collideSleepingCircle(posXI, posYI, speedXI, speedYI, radiusI, posX, posY, radius, neighbours[k]))
+                this->circlesToWake.push_back(neighbours[k]);
+        }
+
+        posX[i] = posXI;
+        posY[i] = posYI;
+        speedX[i] = speedXI;
+        speedY[i] = speedYI;
+    }
+}
+
+template <typename Scalar>
+void BasicWorld<Scalar>::handleCircleCollisionsHierarchicalGrid()
+{
+    int numCircles = this->circles.size();
+    int numAwake = this->numAwakeCircles;
+
+    Scalar* posX = this->circles.posX.data();
+    Scalar* posY = this->circles.posY.data();
+    Scalar* speedX = this->circles.speedX.data();
+    Scalar* speedY = this->circles.speedY.data();
+    const Scalar* radius = this->circles.radius.data();
+    const Scalar* mass = this->circles.mass.data();
+
+    {
+        TRACE_SCOPE("buildHierarchicalGrid");
+        this->circleHierarchicalGrid.build(posX, posY, radius, numCircles, Scalar(GRID_CELL_MARGIN));
+    }
+
+    const int* pairStart = this->circleHierarchicalGrid.pairStart.data();
+    const int* partners = this->circleHierarchicalGrid.partners.data();
+
+    for (int i = 0; i < numAwake; i++)
+    {
+        Scalar posXI = posX[i];
+        Scalar posYI = posY[i];
+        Scalar speedXI = speedX[i];
+        Scalar speedYI = speedY[i];
+        Scalar radiusI = radius[i];
+        Scalar massI = mass[i];
+
+        int k = pairStart[i];
+
+        for (; k < pairStart[i + 1] && partners[k] < numAwake; k++)
+            collideCircles(posXI, posYI, speedXI, speedYI, radiusI, massI, posX, posY, speedX, speedY, radius, mass, partners[k]);
+
+        for (; k < pairStart[i + 1]; k++)
+        {
+            if (collideSleepingCircle(posXI, posYI, speedXI, speedYI, radiusI, posX, posY, radius, partners[k]))
+                this->circlesToWake.push_back(partners[k]);
+        }
+
+        posX[i] = posXI;
+        posY[i] = posYI;
+        speedX[i] = speedXI;
+        speedY[i] = speedYI;
+    }
+}
+
+template <typename Scalar>
+void BasicWorld<Scalar>::handleCircleCollisionsVerlet()
+{
+    int numCircles = this->circles.size();
+    int numAwake = this->numAwakeCircles;
+
+    Scalar* posX = this->circles.posX.data();
+    Scalar* posY = this->circles.posY.data();
+    Scalar* speedX = this->circles.speedX.data();
+    Scalar* speedY = this->circles.speedY.data();
+    const Scalar* radius = this->circles.radius.data();
+    const Scalar* mass = this->circles.mass.data();
+
+    {
+        TRACE_SCOPE("updateVerlet");
+        this->circleVerlet.update(posX, posY, radius, numCircles, this->width, this->height, Scalar(VERLET_MARGIN), this->bodiesVersion);
+    }
+
+    const int* pairStart = this->circleVerlet.pairStart.data();
+    const int* partners = this->circleVerlet.partners.data();
+
+    vector<int>& neighbours = this->circleNeighbours;
+
+    // Set once a push chain has carried some circle too far for the lists; the rest of the pass then uses the grid.
+    bool listsInvalid = false;
+
+    for (int i = 0; i < numAwake; i++)
+    {
+        Scalar posXI = posX[i];
+        Scalar posYI = posY[i];
+        Scalar speedXI = speedX[i];
+        Scalar speedYI = speedY[i];
+        Scalar radiusI = radius[i];
+        Scalar massI = mass[i];
+
+        if (!listsInvalid)
+        {
+            int k = pairStart[i];
+
+            for (; k < pairStart[i + 1] && partners[k] < numAwake; k++)
+                collideCircles(posXI, posYI, speedXI, speedYI, radiusI, massI, posX, posY, speedX, speedY, radius, mass, partners[k]);
+
+            for (; k < pairStart[i + 1]; k++)
+            {
+                if (collideSleepingCircle(posXI, posYI, speedXI, speedYI, radiusI, posX, posY, radius, partners[k]))
+                    this->circlesToWake.push_back(partners[k]);
+            }
+        }
+        else
+        {
+            neighbours.clear();
+            this->circleGrid.queryNeighbours(i, neighbours);
+
+            int k = 0;
+
+            for (; k < neighbours.size() && neighbours[k] < numAwake; k++)
+                collideCircles(posXI, posYI, speedXI, speedYI, radiusI, massI, posX, posY, speedX, speedY, radius, mass, neighbours[k]);
+
+            for (; k < neighbours.size(); k++)
+            {
+                if (collideSleepingCircle(posXI, posYI, speedXI, speedYI, radiusI, posX, posY, radius, neighbours[k]))
+                    this->circlesToWake.push_back(neighbours[k]);
+            }
+        }
+
+        posX[i] = posXI;
+        posY[i] = posYI;
+        speedX[i] = speedXI;
+        speedY[i] = speedYI;
+
+        // Only circle i and its partners moved; if a push chain carried one of them too far, the remaining circles
+        // cannot trust the lists. Only pairs above i are still to come, so switching to the grid keeps the all-pairs
+        // order, and it costs one grid build however many more circles are pushed too far in this pass.
+        if (!listsInvalid && this->circleVerlet.movedTooFar(posX, posY, i))
+        {
+            TRACE_SCOPE("buildGrid");
+            this->circleGrid.build(posX, posY, radius, numCircles, this->width, this->height, Scalar(GRID_CELL_MARGIN));
+
+            this->circleVerlet.invalidate();
+            listsInvalid = true;
+        }
+    }
+}
+
+template <typename Scalar>
+void BasicWorld<Scalar>::gatherCircleContacts()
+{
+    int numCircles = this->circles.size();
+    int numAwake = this->numAwakeCircles;
+
+    const Scalar* posX = this->circles.posX.data();
+    const Scalar* posY = this->circles.posY.data();
+    const Scalar* radius = this->circles.radius.data();
+
+    ThreadPool& threadPool = this->contactThreadPool;
+    threadPool.resize(this->contactThreads);
+
+    int numThreads = threadPool.size();
+
+    this->threadNeighbours.resize(numThreads);
+    this->threadContactPairs.resize(numThreads);
+    this->threadCirclesToWake.resize(numThreads);
+
+    {
+        TRACE_SCOPE("buildGrid");
+        this->circleGrid.build(posX, posY, radius, numCircles, this->width, this->height, Scalar(GRID_CELL_MARGIN));
+    }
+
+    TRACE_SCOPE("gatherContacts");
+
+    for (int t = 0; t < numThreads; t++)
+        this->threadContactPairs[t].clear();
+
+    // Each thread takes a contiguous range of circles, so the concatenated lists are in the all-pairs order.
+    threadPool.parallelFor(numAwake, [&](int thread, int begin, int end)
+    {
+        vector<int>& neighbours = this->threadNeighbours[thread];
+        vector<int>& pairs = this->threadContactPairs[thread];
+
+        for (int i = begin; i < end; i++)
+        {
+            neighbours.clear();
+            this->circleGrid.queryNeighbours(i, neighbours);
+
+            for (int k = 0; k < neighbours.size(); k++)
+            {
+                int j = neighbours[k];
+
+                Scalar deltaX = posX[i] - posX[j];
+                Scalar deltaY = posY[i] - posY[j];
+
+                Scalar cutoff = (radius[i] + radius[j]) * (1 + Scalar(PARALLEL_CONTACT_MARGIN));
+
+                if (deltaX * deltaX + deltaY * deltaY < cutoff * cutoff)
+                {
+                    pairs.push_back(i);
+                    pairs.push_back(j);
+                }
+            }
+        }
+    });
+}
+
+template <typename Scalar>
+void BasicWorld<Scalar>::resolveCircleContacts(const int* pairA, const int* pairB, int begin, int end, vector<int>& wakeList)
+{
+    int numAwake = this->numAwakeCircles;
+
+    Scalar* posX = this->circles.posX.data();
+    Scalar* posY = this->circles.posY.data();
+    Scalar* speedX = this->circles.speedX.data();
+    Scalar* speedY = this->circles.speedY.data();
+    const Scalar* radius = this->circles.radius.data();
+    const Scalar* mass = this->circles.mass.data();
+
+    for (int k = begin; k < end; k++)
+    {
+        int i = pairA[k];
+        int j = pairB[k];
+
+        if (j < numAwake)
+            collideCircles(posX[i], posY[i], speedX[i], speedY[i], radius[i], mass[i], posX, posY, speedX, speedY, radius, mass, j);
+        else if (collideSleepingCircle(posX[i], posY[i], speedX[i], speedY[i], radius[i], posX, posY, radius, j))
+            wakeList.push_back(j);
+    }
+}
+
+template <typename Scalar>
+void BasicWorld<Scalar>::handleCircleCollisionsColored()
+{
+    this->gatherCircleContacts();
+
+    ThreadPool& threadPool = this->contactThreadPool;
+
+    int numThreads = threadPool.size();
+
+    this->contactColoring.clear();
+
+    for (int t = 0; t < numThreads; t++)
+    {
+        const vector<int>& pairs = this->threadContactPairs[t];
+
+        for (int p = 0; p < pairs.size(); p += 2)
+            this->contactColoring.addPair(pairs[p], pairs[p + 1]);
+    }
+
+    {
+        TRACE_SCOPE("colorContacts");
+
+        // Sleeping circles are only read by their contacts.
+        this->contactColoring.color(this->numAwakeCircles);
+    }
+
+    const int* batchStart = this->contactColoring.batchStart.data();
+    const int* batchA = this->contactColoring.batchA.data();
+    const int* batchB = this->contactColoring.batchB.data();
+
+    int numBatches = this->contactColoring.numBatches;
+
+    {
+        TRACE_SCOPE("resolveContacts");
+
+        // No two pairs of a batch share an awake circle, so the order within a batch, and with it the split over
+        // threads, does not change the result.
+        for (int c = 0; c < numBatches; c++)
+        {
+            int begin = batchStart[c];
+            int end = batchStart[c + 1];
+
+            bool overflow = this->contactColoring.overflowBatch && c == numBatches - 1;
+
+            if (overflow || end - begin < MIN_PARALLEL_CONTACT_BATCH)
+            {
+                this->resolveCircleContacts(batchA, batchB, begin, end, this->threadCirclesToWake[0]);
+                continue;
+            }
+
+            threadPool.parallelFor(end - begin, [&](int thread, int sliceBegin, int sliceEnd)
+            {
+                this->resolveCircleContacts(batchA, batchB, begin + sliceBegin, begin + sliceEnd, this->threadCirclesToWake[thread]);
+            });
+        }
+    }
+
+    for (int t = 0; t < numThreads; t++)
+    {
+        this->circlesToWake.insert(this->circlesToWake.end(), this->threadCirclesToWake[t].begin(), this->threadCirclesToWake[t].end());
+        this->threadCirclesToWake[t].clear();
+    }
+}
+
+template <typename Scalar>
+void BasicWorld<Scalar>::handleCircleCollisionsIslands()
+{
+    this->gatherCircleContacts();
+
+    ThreadPool& threadPool = this->contactThreadPool;
+
+    int numThreads = threadPool.size();
+
+    ContactIslands& islands = this->contactIslands;
+
+    islands.clear();
+
+    for (int t = 0; t < numThreads; t++)
+    {
+        const vector<int>& pairs = this->threadContactPairs[t];
+
+        for (int p = 0; p < pairs.size(); p += 2)
+            islands.addPair(pairs[p], pairs[p + 1]);
+    }
+
+    {
+        TRACE_SCOPE("buildIslands");
+
+        // Circles without contacts are in no island and cost nothing from here on.
+        islands.build(this->numAwakeCircles);
+    }
+
+    const int* islandStart = islands.islandStart.data();
+    const int* islandA = islands.islandA.data();
+    const int* islandB = islands.islandB.data();
+
+    int numSharedIslands = islands.numIslands - islands.numSingleBodyIslands;
+
+    {
+        TRACE_SCOPE("resolveIslands");
+
+        // Islands share no awake circle, so which thread solves one, and when, does not change the result.
+        threadPool.parallelForEach(numSharedIslands, [&](int thread, int island)
+        {
+            this->resolveCircleContacts(islandA, islandB, islandStart[island], islandStart[island + 1], this->threadCirclesToWake[thread]);
+        });
+
+        // A circle touching only sleeping ones is a handful of pairs; such islands are split evenly instead of one by one.
+        threadPool.parallelFor(islands.numSingleBodyIslands, [&](int thread, int sliceBegin, int sliceEnd)
+        {
+            this->resolveCircleContacts(islandA, islandB, islandStart[numSharedIslands + sliceBegin], islandStart[numSharedIslands + sliceEnd], this->threadCirclesToWake[thread]);
+        });
+    }
+
+    for (int t = 0; t < numThreads; t++)
+    {
+        this->circlesToWake.insert(this->circlesToWake.end(), this->threadCirclesToWake[t].begin(), this->threadCirclesToWake[t].end());
+        this->threadCirclesToWake[t].clear();
+    }
+}
+
+// Circle i against one capsule, through the batch kernel: pushes the circle out of the capsule and reflects the
+// normal part of its velocity relative to the capsule's surface, damped by friction.
+template <typename Scalar>
+inline void collideCircleCapsule(Scalar* posX, Scalar* posY, Scalar* speedX, Scalar* speedY, const Scalar* radius, int i, const BasicCapsule<Scalar>& capsule, Scalar damping)
+{
+    collideCirclesCapsule(posX, posY, speedX, speedY, radius, i, i + 1, capsule.posX[1], capsule.posY[1], capsule.axisX, capsule.axisY, capsule.length, capsule.radius,
+        capsule.speedX, capsule.speedY, capsule.angularSpeed, damping);
+}
+
+template <typename Scalar>
+void BasicWorld<Scalar>::handleCapsuleCollisions()
+{
+    if (this->numAwakeCircles == 0)
+        return;
+
+    if (this->capsuleBroadphase == CAPSULE_BROADPHASE_AABB_TREE)
+        this->handleCapsuleCollisionsTree();
+    else if (this->capsuleBroadphase == CAPSULE_BROADPHASE_SWEEP_AND_PRUNE)
+        this->handleCapsuleCollisionsSweep();
+    else
+        this->handleCapsuleCollisionsAllPairs();
+}
+
+template <typename Scalar>
+void BasicWorld<Scalar>::handleCapsuleCollisionsAllPairs()
+{
+    int numAwake = this->numAwakeCircles;
+
+    Scalar* posX = this->circles.posX.data();
+    Scalar* posY = this->circles.posY.data();
+    Scalar* speedX = this->circles.speedX.data();
+    Scalar* speedY = this->circles.speedY.data();
+    const Scalar* radius = this->circles.radius.data();
+
+    const vector<BasicCapsule<Scalar>>& capsules = this->capsules;
+
+    Scalar damping = 1 - Scalar(FRICTION) * this->simulationDeltaTime;
+
+    // Capsule by capsule, a vector of circles at a time. A circle's response only depends on the circle itself, so
+    // each circle still meets the capsules in the same order as when looping over circles first.
+    for (int j = 0; j < capsules.size(); j++)
+    {
+        const BasicCapsule<Scalar>& capsule = capsules[j];
+
+        collideCirclesCapsule(posX, posY, speedX, speedY, radius, 0, numAwake, capsule.posX[1], capsule.posY[1], capsule.axisX, capsule.axisY, capsule.length, capsule.radius,
+            capsule.speedX, capsule.speedY, capsule.angularSpeed, damping);
+    }
+}
+
+template <typename Scalar>
+void BasicWorld<Scalar>::handleCapsuleCollisionsSweep()
+{
+    int numCircles = this->circles.size();
+    int numAwake = this->numAwakeCircles;
+
+    Scalar* posX = this->circles.posX.data();
+    Scalar* posY = this->circles.posY.data();
+    Scalar* speedX = this->circles.speedX.data();
+    Scalar* speedY = this->circles.speedY.data();
+    const Scalar* radius = this->circles.radius.data();
+
+    const vector<BasicCapsule<Scalar>>& capsules = this->capsules;
+
+    Scalar damping = 1 - Scalar(FRICTION) * this->simulationDeltaTime;
+
+    // Uses the lists from this substep's circle pass when there was one; SWEEP_MARGIN covers what circles moved since.
+    if (this->circleBroadphase != CIRCLE_BROADPHASE_SWEEP_AND_PRUNE || this->circleSweep.bodiesVersion != this->bodiesVersion)
+        this->circleSweep.update(posX, posY, radius, numCircles, capsules.data(), (int)capsules.size(), Scalar(SWEEP_MARGIN), this->bodiesVersion);
+
+    for (int i = 0; i < numAwake; i++)
+    {
+        const vector<int>& partners = this->circleSweep.partners[i];
+
+        int first = (int)(lower_bound(partners.begin(), partners.end(), numCircles) - partners.begin());
+
+        for (int k = first; k < partners.size(); k++)
+            collideCircleCapsule(posX, posY, speedX, speedY, radius, i, capsules[partners[k] - numCircles], damping);
+    }
+}
+
+template <typename Scalar>
+void BasicWorld<Scalar>::handleCapsuleCollisionsTree()
+{
+    int numAwake = this->numAwakeCircles;
+
+    Scalar* posX = this->circles.posX.data();
+    Scalar* posY = this->circles.posY.data();
+    Scalar* speedX = this->circles.speedX.data();
+    Scalar* speedY = this->circles.speedY.data();
+    const Scalar* radius = this->circles.radius.data();
+
+    const vector<BasicCapsule<Scalar>>& capsules = this->capsules;
+
+    Scalar damping = 1 - Scalar(FRICTION) * this->simulationDeltaTime;
+
+    this->updateCapsuleTree();
+
+    vector<int>& neighbours = this->circleNeighbours;
+
+    for (int i = 0; i < numAwake; i++)
+    {
+        neighbours.clear();
+        this->capsuleTree.query(circleBox(posX[i], posY[i], radius[i] * (1 + Scalar(AABB_TREE_QUERY_MARGIN))), neighbours);
+
+        sort(neighbours.begin(), neighbours.end());
+
+        for (int k = 0; k < neighbours.size(); k++)
+            collideCircleCapsule(posX, posY, speedX, speedY, radius, i, capsules[neighbours[k]], damping);
+    }
+}
+
+template <typename Scalar>
+void BasicWorld<Scalar>::sweepFastCircles()
+{
+    int numCircles = this->circles.size();
+    int numAwake = this->numAwakeCircles;
+
+    const Scalar* posX = this->circles.posX.data();
+    const Scalar* posY = this->circles.posY.data();
+    const Scalar* speedX = this->circles.speedX.data();
+    const Scalar* speedY = this->circles.speedY.data();
+    const Scalar* radius = this->circles.radius.data();
+
+    Scalar simulationDeltaTime = this->simulationDeltaTime;
+
+    // With multirateStepping a circle of level k moves by 2^k substeps, and its motion is swept over that step. All of
+    // them end the substep at the same time, so the motions are still swept side by side.
+    const Scalar* stepMultiplier = this->levelStepMultipliers();
+
+    this->circleSteps.resize(numAwake);
+
+    Scalar* step = this->circleSteps.data();
+
+    for (int i = 0; i < numAwake; i++)
+        step[i] = stepMultiplier != nullptr ? simulationDeltaTime * stepMultiplier[i] : simulationDeltaTime;
+
+    this->circleMotionFraction.assign(numAwake, Scalar(1));
+    this->fastCircles.clear();
+
+    Scalar fastMotion = Scalar(CCD_MOTION_FRACTION);
+
+    for (int i = 0; i < numAwake; i++)
+    {
+        Scalar motionSquared = (speedX[i] * speedX[i] + speedY[i] * speedY[i]) * step[i] * step[i];
+
+        if (motionSquared > fastMotion * fastMotion * radius[i] * radius[i])
+            this->fastCircles.push_back(i);
+    }
+
+    if (this->fastCircles.empty())
+        return;
+
+    this->sweptCircles += (int)this->fastCircles.size();
+
+    Scalar* motionFraction = this->circleMotionFraction.data();
+
+    // Each fast circle is tested against the capsules its swept box touches, and against the circles whose paths lie
+    // near its own in a grid of the paths.
+    vector<char>& fast = this->circleIsFast;
+
+    fast.assign(numAwake, 0);
+
+    for (int k = 0; k < this->fastCircles.size(); k++)
+        fast[this->fastCircles[k]] = 1;
+
+    this->circleSweptX.resize(numCircles);
+    this->circleSweptY.resize(numCircles);
+    this->circleSweptRadius.resize(numCircles);
+
+    Scalar* sweptX = this->circleSweptX.data();
+    Scalar* sweptY = this->circleSweptY.data();
+    Scalar* sweptRadius = this->circleSweptRadius.data();
+
+    // A path is the circle swept from its position to where its speed takes it, which lies within the circle around
+    // the middle of the motion. Sleeping circles keep still.
+    for (int i = 0; i < numCircles; i++)
+    {
+        Scalar motionX = i < numAwake ? speedX[i] * step[i] : Scalar(0);
+        Scalar motionY = i < numAwake ? speedY[i] * step[i] : Scalar(0);
+
+        sweptX[i] = posX[i] + motionX / 2;
+        sweptY[i] = posY[i] + motionY / 2;
+        sweptRadius[i] = radius[i] + sqrt(motionX * motionX + motionY * motionY) / 2;
+    }
+
+    this->circleGrid.build(sweptX, sweptY, sweptRadius, numCircles, this->width, this->height, Scalar(0));
+
+    vector<int>& neighbours = this->circleNeighbours;
+
+    Scalar halfWidth = this->width / 2;
+    Scalar halfHeight = this->height / 2;
+
+    Scalar targetOverlap = Scalar(CCD_TARGET_OVERLAP);
+
+    for (int k = 0; k < this->fastCircles.size(); k++)
+    {
+        int a = this->fastCircles[k];
+
+        Scalar motionX = speedX[a] * step[a];
+        Scalar motionY = speedY[a] * step[a];
+
+        Scalar minX = min(posX[a], posX[a] + motionX) - radius[a];
+        Scalar maxX = max(posX[a], posX[a] + motionX) + radius[a];
+        Scalar minY = min(posY[a], posY[a] + motionY) - radius[a];
+        Scalar maxY = max(posY[a], posY[a] + motionY) + radius[a];
+
+        // Walls.
+        Scalar overlap = targetOverlap * radius[a];
+        Scalar timeOfImpact = 1;
+
+        timeOfImpact = min(timeOfImpact, sweepPointWall(posX[a] - radius[a] + halfWidth + overlap, -motionX));
+        timeOfImpact = min(timeOfImpact, sweepPointWall(halfWidth - posX[a] - radius[a] + overlap, motionX));
+        timeOfImpact = min(timeOfImpact, sweepPointWall(posY[a] - radius[a] + halfHeight + overlap, -motionY));
+        timeOfImpact = min(timeOfImpact, sweepPointWall(halfHeight - posY[a] - radius[a] + overlap, motionY));
+
+        // Capsules, which do not move during the substep.
+        for (int j = 0; j < this->capsules.size(); j++)
+        {
+            const BasicCapsule<Scalar>& capsule = this->capsules[j];
+
+            if (maxX < capsule.box.minX || minX > capsule.box.maxX || maxY < capsule.box.minY || minY > capsule.box.maxY)
+                continue;
+
+            Scalar dist = radius[a] + capsule.radius - targetOverlap * min(radius[a], capsule.radius);
+
+            timeOfImpact = min(timeOfImpact, sweepPointCapsule(posX[a], posY[a], motionX, motionY, capsule, dist));
+        }
+
+        if (timeOfImpact < 1)
+            this->timeOfImpactHits++;
+
+        motionFraction[a] = min(motionFraction[a], timeOfImpact);
+
+        // Circles, swept relative to each other; both stop at the time of impact. Pairs of fast circles are tested once.
+        neighbours.clear();
+        this->circleGrid.queryAround(a, neighbours);
+
+        for (int n = 0; n < neighbours.size(); n++)
+        {
+            int b = neighbours[n];
+
+            if (b < numAwake && fast[b] && b < a)
+                continue;
+
+            Scalar motionBX = b < numAwake ? speedX[b] * step[b] : Scalar(0);
+            Scalar motionBY = b < numAwake ? speedY[b] * step[b] : Scalar(0);
+
+            if (min(posX[b], posX[b] + motionBX) - radius[b] > maxX || max(posX[b], posX[b] + motionBX) + radius[b] < minX)
+                continue;
+            if (min(posY[b], posY[b] + motionBY) - radius[b] > maxY || max(posY[b], posY[b] + motionBY) + radius[b] < minY)
+                continue;
+
+            Scalar dist = radius[a] + radius[b] - targetOverlap * min(radius[a], radius[b]);
+
+            Scalar pairTimeOfImpact = sweepPointCircle(posX[a] - posX[b], posY[a] - posY[b], motionX - motionBX, motionY - motionBY, dist);
+
+            if (pairTimeOfImpact >= 1)
+                continue;
+
+            this->timeOfImpactHits++;
+
+            motionFraction[a] = min(motionFraction[a], pairTimeOfImpact);
+
+            if (b < numAwake)
+                motionFraction[b] = min(motionFraction[b], pairTimeOfImpact);
+        }
+    }
+}
+
+template <typename Scalar>
+void BasicWorld<Scalar>::sweepCirclesAgainstMovingCapsules()
+{
+    int numAwake = this->numAwakeCircles;
+
+    Scalar* posX = this->circles.posX.data();
+    Scalar* posY = this->circles.posY.data();
+    const Scalar* speedX = this->circles.speedX.data();
+    const Scalar* speedY = this->circles.speedY.data();
+    const Scalar* radius = this->circles.radius.data();
+
+    Scalar simulationDeltaTime = this->simulationDeltaTime;
+
+    Scalar targetOverlap = Scalar(CCD_TARGET_OVERLAP);
+
+    // Only the player capsule moves in most scenes, so each moving capsule is tested against the awake circles its
+    // swept box touches.
+    for (int j = 0; j < this->capsules.size(); j++)
+    {
+        const BasicCapsule<Scalar>& capsule = this->capsules[j];
+
+        if (!capsule.isMoving())
+            continue;
+
+        Aabb<Scalar> box = capsule.sweptBox(simulationDeltaTime);
+
+        for (int i = 0; i < numAwake; i++)
+        {
+            Scalar motionX = speedX[i] * simulationDeltaTime;
+            Scalar motionY = speedY[i] * simulationDeltaTime;
+
+            Aabb<Scalar> circleSweptBox = { min(posX[i], posX[i] + motionX) - radius[i], min(posY[i], posY[i] + motionY) - radius[i],
+                max(posX[i], posX[i] + motionX) + radius[i], max(posY[i], posY[i] + motionY) + radius[i] };
+
+            if (!box.overlaps(circleSweptBox))
+                continue;
+
+            // The capsule is held still and the circle moves relative to the surface point nearest to it, which
+            // follows the rotation closely enough for the angles of one substep.
+            Scalar surfaceSpeedX;
+            Scalar surfaceSpeedY;
+
+            capsule.surfaceSpeed(posX[i], posY[i], surfaceSpeedX, surfaceSpeedY);
+
+            Scalar relativeMotionX = motionX - surfaceSpeedX * simulationDeltaTime;
+            Scalar relativeMotionY = motionY - surfaceSpeedY * simulationDeltaTime;
+
+            Scalar dist = radius[i] + capsule.radius - targetOverlap * min(radius[i], capsule.radius);
+
+            Scalar timeOfImpact = sweepPointCapsule(posX[i], posY[i], relativeMotionX, relativeMotionY, capsule, dist);
+
+            if (timeOfImpact >= 1)
+                continue;
+
+            this->movingCapsuleHits++;
+
+            // From the impact on the circle rides along with the surface instead of moving into the capsule; the
+            // integration still adds the circle's own motion.
+            posX[i] -= relativeMotionX * (1 - timeOfImpact);
+            posY[i] -= relativeMotionY * (1 - timeOfImpact);
+        }
+    }
+}
+
+template <typename Scalar>
+void BasicWorld<Scalar>::updateCirclesStatuses()
+{
+    // Set by sweepFastCircles when continuousCollisions is on.
+    const Scalar* motionFraction = this->continuousCollisions ? this->circleMotionFraction.data() : nullptr;
+
+    // Sleeping circles keep still; while gravity follows a circle, every circle is awake.
+    if (!this->multirateStepping)
+    {
+        this->integrateCircles(0, this->numAwakeCircles, this->simulationDeltaTime, motionFraction);
+        return;
+    }
+
+    // Every level taking part in the substep moves by its own step.
+    for (int level = 0; level < this->levelSubsteps(this->multirateSubstep); level++)
+        this->integrateCircles(this->levelBegin(level), this->levelEnd(level), this->simulationDeltaTime * Scalar(1 << level), motionFraction);
+}
+
+template <typename Scalar>
+void BasicWorld<Scalar>::integrateCircles(int begin, int end, Scalar deltaTime, const Scalar* motionFraction)
+{
+    Scalar* posX = this->circles.posX.data();
+    Scalar* posY = this->circles.posY.data();
+    Scalar* speedX = this->circles.speedX.data();
+    Scalar* speedY = this->circles.speedY.data();
+
+    Scalar frictionFactor = 1 - Scalar(FRICTION) * deltaTime;
+
+    int gravitySource = this->changedGravityActive ? this->circleRegistry.denseIndex(this->gravitySource) : -1;
+
+    if (this->changedGravityActive && gravitySource == -1)
+    {
+        // The gravity source was despawned: fall back to the usual downward gravity.
+        this->changedGravityActive = false;
+        this->currentGravityX = 0;
+        this->currentGravityY = -Scalar(SCALAR_GRAVITY);
+    }
+
+    if (this->changedGravityActive)
+    {
+        for (int i = begin; i < end; i++)
+        {
+            if (i != gravitySource)
+            {
+                Scalar deltaX = posX[gravitySource] - posX[i];
+                Scalar deltaY = posY[gravitySource] - posY[i];
+
+                Scalar dist = sqrt(deltaX * deltaX + deltaY * deltaY);
+
+                this->currentGravityX = deltaX / dist * Scalar(SCALAR_GRAVITY);
+                this->currentGravityY = deltaY / dist * Scalar(SCALAR_GRAVITY);
+
+                speedX[i] += this->currentGravityX * deltaTime;
+                speedY[i] += this->currentGravityY * deltaTime;
+            }
+            else
+            {
+                this->currentGravityX = 0;
+                this->currentGravityY = 0;
+            }
+
+            Scalar motionTime = motionFraction != nullptr ? deltaTime * motionFraction[i] : deltaTime;
+
+            posX[i] += speedX[i] * motionTime;
+            posY[i] += speedY[i] * motionTime;
+
+            speedX[i] += this->currentGravityX * deltaTime;
+            speedY[i] += this->currentGravityY * deltaTime;
+
+            speedX[i] *= frictionFactor;
+            speedY[i] *= frictionFactor;
+        }
+
+        return;
+    }
+
+    // Uniform gravity: a branch-free streaming loop over the arrays.
+    Scalar gravityX = this->currentGravityX * deltaTime;
+    Scalar gravityY = this->currentGravityY * deltaTime;
+
+    if (motionFraction != nullptr)
+    {
+        for (int i = begin; i < end; i++)
+        {
+            posX[i] += speedX[i] * deltaTime * motionFraction[i];
+            posY[i] += speedY[i] * deltaTime * motionFraction[i];
+
+            speedX[i] = (speedX[i] + gravityX) * frictionFactor;
+            speedY[i] = (speedY[i] + gravityY) * frictionFactor;
+        }
+
+        return;
+    }
+
+    for (int i = begin; i < end; i++)
+    {
+        posX[i] += speedX[i] * deltaTime;
+        posY[i] += speedY[i] * deltaTime;
+
+        speedX[i] = (speedX[i] + gravityX) * frictionFactor;
+        speedY[i] = (speedY[i] + gravityY) * frictionFactor;
+    }
+}
+
+template <typename Scalar>
+void BasicWorld<Scalar>::updateCapsulesStatuses()
+{
+    for (int j = 0; j < this->capsules.size(); j++)
+    {
+        if (!this->capsules[j].isMoving())
+            continue;
+
+        this->capsules[j].move(this->simulationDeltaTime);
+
+        this->refitCapsule(j);
+    }
+}
+
+template <typename Scalar>
+void BasicWorld<Scalar>::assignCircleLevels(double deltaTime)
+{
+    int numCircles = this->circles.size();
+    int numAwake = this->numAwakeCircles;
+
+    this->multirateAwakeCircles = numAwake;
+
+    // Every level must divide the frame and keep at least minSubsteps steps in it.
+    int levels = 1;
+
+    while (levels < 16 && this->frameSubsteps % (1 << levels) == 0 && (this->frameSubsteps >> levels) >= this->minSubsteps)
+        levels++;
+
+    this->multirateLevels = levels;
+    this->circleLevelEnds.assign(levels - 1, numAwake);
+
+    if (levels == 1 || numAwake == 0)
+        return;
+
+    const Scalar* posX = this->circles.posX.data();
+    const Scalar* posY = this->circles.posY.data();
+    const Scalar* speedX = this->circles.speedX.data();
+    const Scalar* speedY = this->circles.speedY.data();
+    const Scalar* radius = this->circles.radius.data();
+
+    vector<int>& speedLevels = this->circleSpeedLevels;
+    vector<int>& circleLevels = this->circleLevels;
+
+    speedLevels.assign(numAwake, 0);
+
+    // The same bound as chooseSubsteps, per circle: the coarsest level whose step moves it at most
+    // substepSafetyFactor times its radius.
+    double step = (double)this->simulationDeltaTime;
+    Scalar maxRadius = 0;
+
+    for (int i = 0; i < numAwake; i++)
+    {
+        double speed = sqrt((double)(speedX[i] * speedX[i] + speedY[i] * speedY[i])) + SCALAR_GRAVITY * deltaTime;
+        double limit = (double)this->substepSafetyFactor * (double)radius[i];
+
+        int level = 0;
+
+        while (level + 1 < levels && speed * step * (2 << level) <= limit)
+            level++;
+
+        speedLevels[i] = level;
+
+        maxRadius = max(maxRadius, radius[i]);
+    }
+
+    // Circles a moving capsule may reach during the frame take every substep, so they are swept against it.
+    for (int j = 0; j < this->capsules.size(); j++)
+    {
+        if (!this->capsules[j].isMoving())
+            continue;
+
+        Aabb<Scalar> box = this->capsules[j].sweptBox(Scalar(deltaTime));
+
+        for (int i = 0; i < numAwake; i++)
+        {
+            if (box.overlaps(circleBox(posX[i], posY[i], radius[i])))
+                speedLevels[i] = 0;
+        }
+    }
+
+    circleLevels = speedLevels;
+
+    // Circles about to touch step together at the finer level. Only the partners' own levels are taken, so a fast
+    // circle does not drag a whole pile down with it.
+    Scalar margin = Scalar(MULTIRATE_CONTACT_MARGIN);
+
+    // Circles of zero radius never touch, so there is nothing to pair up.
+    if (maxRadius > 0)
+    {
+        this->circleGrid.build(posX, posY, radius, numAwake, this->width, this->height, margin / (2 * maxRadius));
+
+        vector<int>& neighbours = this->circleNeighbours;
+
+        for (int i = 0; i < numAwake; i++)
+        {
+            neighbours.clear();
+            this->circleGrid.queryNeighbours(i, neighbours);
+
+            for (int k = 0; k < neighbours.size(); k++)
+            {
+                int j = neighbours[k];
+
+                Scalar deltaX = posX[j] - posX[i];
+                Scalar deltaY = posY[j] - posY[i];
+
+                Scalar contactDist = radius[i] + radius[j] + margin;
+
+                if (deltaX * deltaX + deltaY * deltaY >= contactDist * contactDist)
+                    continue;
+
+                circleLevels[i] = min(circleLevels[i], speedLevels[j]);
+                circleLevels[j] = min(circleLevels[j], speedLevels[i]);
+            }
+        }
+    }
+
+    // A stable counting sort of the awake prefix by level; sleeping circles keep their places.
+    vector<int> levelStarts(levels + 1, 0);
+
+    for (int i = 0; i < numAwake; i++)
+        levelStarts[circleLevels[i] + 1]++;
+
+    for (int k = 0; k < levels; k++)
+        levelStarts[k + 1] += levelStarts[k];
+
+    for (int k = 0; k < levels - 1; k++)
+        this->circleLevelEnds[k] = levelStarts[k + 1];
+
+    vector<int> order(numCircles);
+
+    bool unchanged = true;
+
+    for (int i = 0; i < numAwake; i++)
+    {
+        int n = levelStarts[circleLevels[i]]++;
+
+        order[n] = i;
+
+        if (n != i)
+            unchanged = false;
+    }
+
+    for (int n = numAwake; n < numCircles; n++)
+        order[n] = n;
+
+    if (!unchanged)
+        this->permuteCircles(order);
+}
+
+template <typename Scalar>
+int BasicWorld<Scalar>::levelSubsteps(int substep) const
+{
+    // Level k steps in the substeps divisible by 2^k.
+    int levels = 1;
+
+    while (levels < this->multirateLevels && substep % (1 << levels) == 0)
+        levels++;
+
+    return levels;
+}
+
+template <typename Scalar>
+const Scalar* BasicWorld<Scalar>::levelStepMultipliers()
+{
+    if (!this->multirateStepping)
+        return nullptr;
+
+    this->circleStepMultipliers.resize(this->numAwakeCircles);
+
+    for (int level = 0; level < this->levelSubsteps(this->multirateSubstep); level++)
+    {
+        for (int i = this->levelBegin(level); i < this->levelEnd(level); i++)
+            this->circleStepMultipliers[i] = Scalar(1 << level);
+    }
+
+    return this->circleStepMultipliers.data();
+}
+
+template <typename Scalar>
+int BasicWorld<Scalar>::levelBegin(int level) const
+{
+    return level == 0 ? 0 : this->circleLevelEnds[level - 1];
+}
+
+template <typename Scalar>
+int BasicWorld<Scalar>::levelEnd(int level) const
+{
+    return level < this->multirateLevels - 1 ? this->circleLevelEnds[level] : this->multirateAwakeCircles;
+}
+
+template <typename Scalar>
+void BasicWorld<Scalar>::promoteCircles()
+{
+    vector<int>& circlesToWake = this->circlesToWake;
+
+    sort(circlesToWake.begin(), circlesToWake.end());
+    circlesToWake.erase(unique(circlesToWake.begin(), circlesToWake.end()), circlesToWake.end());
+
+    // The swaps below move circles around, so the list is kept as handles.
+    vector<BodyHandle>& circlesToPromote = this->circlesToPromote;
+
+    circlesToPromote.clear();
+
+    for (int k = 0; k < circlesToWake.size(); k++)
+    {
+        if (circlesToWake[k] >= this->levelEnd(0))
+            circlesToPromote.push_back(this->circleRegistry.handleAt(circlesToWake[k]));
+    }
+
+    circlesToWake.clear();
+
+    if (circlesToPromote.empty())
+        return;
+
+    for (int k = 0; k < circlesToPromote.size(); k++)
+    {
+        int i = this->circleRegistry.denseIndex(circlesToPromote[k]);
+
+        int level = this->multirateLevels - 1;
+
+        if (i >= this->multirateAwakeCircles)
+        {
+            // A sleeping circle is still, so it joins the last level with nothing to catch up on.
+            if (i != this->multirateAwakeCircles)
+                this->swapCircles(i, this->multirateAwakeCircles);
+
+            i = this->multirateAwakeCircles;
+
+            this->circleSleepTime[i] = 0;
+            this->multirateAwakeCircles++;
+        }
+        else
+        {
+            while (level > 0 && i < this->levelBegin(level))
+                level--;
+
+            // The circle last stepped at the end of a substep divisible by 2^level; the others have reached the end of
+            // the previous substep.
+            int lag = (this->multirateSubstep - 1) % (1 << level);
+
+            if (lag > 0)
+                this->integrateCircles(i, i + 1, this->simulationDeltaTime * Scalar(lag), nullptr);
+        }
+
+        // Down one level at a time: the circle trades places with the first of its level, which becomes the last of
+        // the level below.
+        for (int l = level; l > 0; l--)
+        {
+            int first = this->levelBegin(l);
+
+            if (i != first)
+                this->swapCircles(i, first);
+
+            i = first;
+            this->circleLevelEnds[l - 1]++;
+        }
+
+        this->promotedCircles++;
+    }
+
+    this->numAwakeCircles = this->levelEnd(this->levelSubsteps(this->multirateSubstep) - 1);
+
+    this->bodiesVersion++;
+}
+
+template <typename Scalar>
+void BasicWorld<Scalar>::promoteFastCircles()
+{
+    const Scalar* posX = this->circles.posX.data();
+    const Scalar* posY = this->circles.posY.data();
+    const Scalar* speedX = this->circles.speedX.data();
+    const Scalar* speedY = this->circles.speedY.data();
+    const Scalar* radius = this->circles.radius.data();
+
+    Scalar safetyFactor = this->substepSafetyFactor;
+
+    for (int level = 1; level < this->multirateLevels; level++)
+    {
+        Scalar step = this->simulationDeltaTime * Scalar(1 << level);
+
+        for (int i = this->levelBegin(level); i < this->levelEnd(level); i++)
+        {
+            Scalar motionSquared = (speedX[i] * speedX[i] + speedY[i] * speedY[i]) * step * step;
+            Scalar limit = safetyFactor * radius[i];
+
+            if (motionSquared > limit * limit)
+                this->circlesToWake.push_back(i);
+        }
+
+        for (int j = 0; j < this->capsules.size(); j++)
+        {
+            if (!this->capsules[j].isMoving())
+                continue;
+
+            Aabb<Scalar> box = this->capsules[j].sweptBox(step);
+
+            for (int i = this->levelBegin(level); i < this->levelEnd(level); i++)
+            {
+                if (box.overlaps(circleBox(posX[i], posY[i], radius[i])))
+                    this->circlesToWake.push_back(i);
+            }
+        }
+    }
+
+    if (!this->circlesToWake.empty())
+        this->promoteCircles();
+}
+
+template <typename Scalar>
+int BasicWorld<Scalar>::chooseSubsteps(double deltaTime) const
+{
+    int numCircles = this->circles.size();
+
+    const Scalar* speedX = this->circles.speedX.data();
+    const Scalar* speedY = this->circles.speedY.data();
+    const Scalar* radius = this->circles.radius.data();
+
+    Scalar maxSpeedSquared = 0;
+    Scalar minRadius = numeric_limits<Scalar>::max();
+
+    for (int i = 0; i < this->numAwakeCircles; i++)
+        maxSpeedSquared = max(maxSpeedSquared, speedX[i] * speedX[i] + speedY[i] * speedY[i]);
+
+    for (int i = 0; i < numCircles; i++)
+        minRadius = min(minRadius, radius[i]);
+
+    for (int j = 0; j < this->capsules.size(); j++)
+        minRadius = min(minRadius, this->capsules[j].radius);
+
+    if (numCircles == 0 || minRadius <= 0)
+        return this->minSubsteps;
+
+    // In double, so a huge speed cannot overflow the count.
+    double maxSpeed = sqrt((double)maxSpeedSquared) + SCALAR_GRAVITY * deltaTime;
+    double substeps = ceil(maxSpeed * deltaTime / ((double)this->substepSafetyFactor * (double)minRadius));
+
+    substeps = min(max(substeps, (double)this->minSubsteps), (double)this->maxSubsteps);
+
+    // A power of two splits into the most levels.
+    if (this->multirateStepping)
+        substeps = min(pow(2.0, ceil(log2(substeps))), (double)this->maxSubsteps);
+
+    return (int)substeps;
+}
+
+template <typename Scalar>
+void BasicWorld<Scalar>::simulate(double deltaTime, const InputState& input)
+{
+    if (this->inputPlayer != nullptr && this->frameIndex < this->inputPlayer->frames())
+        deltaTime = this->inputPlayer->frameDeltaTime(this->frameIndex);
+
+    if (this->inputRecorder != nullptr)
+        this->inputRecorder->recordFrame(this->frameIndex, deltaTime);
+
+    this->frameSubsteps = this->adaptiveSubsteps ? this->chooseSubsteps(deltaTime) : this->numberOfSimulations;
+
+    this->simulationDeltaTime = Scalar(deltaTime / this->frameSubsteps);
+
+    this->sweptCircles = 0;
+    this->timeOfImpactHits = 0;
+    this->movingCapsuleHits = 0;
+
+    this->multirateCircleSteps = 0;
+    this->promotedCircles = 0;
+
+    if (this->reorderInterval > 0 && this->frameIndex % this->reorderInterval == 0)
+    {
+        TRACE_SCOPE("reorderCircles");
+        this->reorderCircles();
+    }
+
+    if (this->multirateStepping)
+    {
+        TRACE_SCOPE("assignCircleLevels");
+        this->assignCircleLevels(deltaTime);
+    }
+
+    for (int i = 1; i <= this->frameSubsteps; i++)
+    {
+        {
+            TRACE_SCOPE_INDEX("handleInput", i);
+
+            const InputState& substepInput = this->inputPlayer != nullptr ? this->inputPlayer->stateAt(this->frameIndex, i) : input;
+
+            if (this->inputRecorder != nullptr)
+                this->inputRecorder->recordSubstep(this->frameIndex, i, substepInput);
+
+            this->handleInput(substepInput);
+        }
+
+        if (this->multirateStepping)
+        {
+            // Only the levels stepping in this substep are awake to the passes below.
+            this->multirateSubstep = i;
+            this->multirateAwakeCircles = this->numAwakeCircles;
+            this->numAwakeCircles = this->levelEnd(this->levelSubsteps(i) - 1);
+
+            // Circles the input woke step from this substep on, at level 0, like circles woken by a contact. On the
+            // coarsest level they would be moved over the part of its step they slept through.
+            if (!this->circlesToWake.empty())
+                this->promoteCircles();
+        }
+
+        // A substep no circle takes part in would only cost the impulse solver its warm start.
+        if (!this->multirateStepping || this->numAwakeCircles > 0)
+        {
+            TRACE_SCOPE_INDEX("handleCollisions", i);
+            this->handleCollisions();
+
+            if (!this->circlesToWake.empty())
+            {
+                if (this->multirateStepping)
+                    this->promoteCircles();
+                else
+                    this->wakeCircles();
+            }
+        }
+
+        if (this->multirateStepping)
+        {
+            TRACE_SCOPE_INDEX("promoteFastCircles", i);
+            this->promoteFastCircles();
+        }
+
+        if (this->continuousCollisions)
+        {
+            TRACE_SCOPE_INDEX("sweepFastCircles", i);
+            this->sweepFastCircles();
+        }
+
+        {
+            TRACE_SCOPE_INDEX("sweepCirclesAgainstMovingCapsules", i);
+            this->sweepCirclesAgainstMovingCapsules();
+        }
+
+        {
+            TRACE_SCOPE_INDEX("updateCirclesStatuses", i);
+            this->updateCirclesStatuses();
+        }
+
+        {
+            TRACE_SCOPE_INDEX("updateCapsulesStatuses", i);
+            this->updateCapsulesStatuses();
+        }
+
+        if (this->multirateStepping)
+        {
+            this->multirateCircleSteps += this->numAwakeCircles;
+            this->numAwakeCircles = this->multirateAwakeCircles;
+        }
+    }
+
+    {
+        TRACE_SCOPE("updateSleeping");
+        this->updateSleeping(Scalar(deltaTime));
+    }
+
+    this->frameIndex++;
+}
+
+template <typename Scalar>
+BasicCircle<Scalar> createRandomCircle(const BasicWorld<Scalar>& world, double minRadius, double maxRadius)
+{
+    double width = world.width;
+    double height = world.height;
+
+    return BasicCircle<Scalar>(Scalar(1.0 * rand() / RAND_MAX * width - width / 2.0), Scalar(1.0 * rand() / RAND_MAX * height - height / 2.0), Scalar(minRadius + (maxRadius - minRadius) * rand() / RAND_MAX), 1.0 * rand() / RAND_MAX, 1.0 * rand() / RAND_MAX, 1.0 * rand() / RAND_MAX);
+}
+
+template <typename Scalar>
+void createDefaultScene(BasicWorld<Scalar>& world, int numCircles, int numCapsules, unsigned int seed, double minRadius, double maxRadius)
+{
+    srand(seed);
+
+    vector<BasicCircle<Scalar>> newCircles;
+
+    for (int i = 1; i <= numCircles; i++)
+        newCircles.push_back(createRandomCircle(world, minRadius, maxRadius));
+
+    world.addCircles(newCircles);
+
+    if (!world.circleColdData.empty())
+        world.circleColdData[0].playerControlled = true;
+
+    if (numCapsules >= 1)
+    {
+        world.addCapsule(BasicCapsule<Scalar>(10, 10, 470, 425, 10));
+
+        world.capsules[0].playerControlled = true;
+    }
+
+    for (int j = 2; j <= numCapsules; j++)
+    {
+        double middleX = 1.0 * rand() / RAND_MAX * world.width - world.width / 2.0;
+        double middleY = 1.0 * rand() / RAND_MAX * world.height - world.height / 2.0;
+
+        double halfLength = 30.0 + 50.0 * rand() / RAND_MAX;
+        double angle = 2.0 * PI * rand() / RAND_MAX;
+
+        world.addCapsule(BasicCapsule<Scalar>(Scalar(middleX - halfLength * cos(angle)), Scalar(middleY - halfLength * sin(angle)), Scalar(middleX + halfLength * cos(angle)), Scalar(middleY + halfLength * sin(angle)), 10));
+    }
+}
+
+template struct BasicCircle<float>;
+template struct BasicCircle<double>;
+
+template struct BasicCircleArrays<float>;
+template struct BasicCircleArrays<double>;
+
+template struct BasicCapsule<float>;
+template struct BasicCapsule<double>;
+
+template struct BasicWorld<float>;
+template struct BasicWorld<double>;
+
+template BasicCircle<float> createRandomCircle(const BasicWorld<float>& world, double minRadius, double maxRadius);
+template BasicCircle<double> createRandomCircle(const BasicWorld<double>& world, double minRadius, double maxRadius);
+
+template void createDefaultScene(BasicWorld<float>& world, int numCircles, int numCapsules, unsigned int seed, double minRadius, double maxRadius);
+template void createDefaultScene(BasicWorld<double>& world, int numCircles, int numCapsules, unsigned int seed, double minRadius, double maxRadius);
@@ -0,0 +1,620 @@
+#pragma once
+
+#include <vector>
+
+#include "AlignedAllocator.h"
+#include "BodyRegistry.h"
+#include "UniformGrid.h"
+#include "SweepAndPrune.h"
+#include "AabbTree.h"
+#include "VerletList.h"
+#include "HierarchicalGrid.h"
+#include "UnionFind.h"
+#include "ContactColoring.h"
+#include "ContactIslands.h"
+#include "ThreadPool.h"
+#include "ImpulseSolver.h"
+#include "XpbdSolver.h"
+
+const double WINDOW_WIDTH = 768.0;
+const double WINDOW_HEIGHT = 768.0;
+
+const double SCALAR_GRAVITY = 500.0;
+
+const double FRICTION = 0.7;
+
+const double PI = 3.14159265359;
+
+// Radius range of randomly spawned circles.
+const double SPAWN_MIN_RADIUS = 10.0;
+const double SPAWN_MAX_RADIUS = 20.0;
+
+const int NUMBER_OF_SIMULATIONS = 256;
+
+// Adaptive substeps: no awake circle may move more than SUBSTEP_SAFETY_FACTOR times the smallest radius in one substep,
+// with the count kept between the two bounds. The lower bound is what a quiet scene costs.
+const double SUBSTEP_SAFETY_FACTOR = 0.25;
+const int MIN_ADAPTIVE_SUBSTEPS = 4;
+const int MAX_ADAPTIVE_SUBSTEPS = NUMBER_OF_SIMULATIONS;
+
+// Multirate stepping: circles closer than this to touching, in world units, step at the finer of their two levels.
+const double MULTIRATE_CONTACT_MARGIN = 2.0;
+
+// Continuous collisions: circles moving more than CCD_MOTION_FRACTION of their radius in a substep are swept, and
+// stopped where they first overlap what they hit by CCD_TARGET_OVERLAP of the smaller radius.
+const double CCD_MOTION_FRACTION = 0.5;
+const double CCD_TARGET_OVERLAP = 0.1;
+
+// Extra grid cell width, as a fraction of the largest diameter, so pairs pushed together during a pass are still candidates.
+const double GRID_CELL_MARGIN = 0.25;
+
+// How far each sweep-and-prune interval is widened, as a fraction of the body's radius, for the same reason.
+const double SWEEP_MARGIN = 0.5;
+
+// AABB tree leaves are grown by this fraction of the body's radius, so a body is only reinserted after moving that far.
+const double AABB_TREE_FAT_MARGIN = 0.5;
+
+// How far a circle's query box is widened, as a fraction of its radius, to cover motion during the pass.
+const double AABB_TREE_QUERY_MARGIN = 0.5;
+
+// Default Verlet skin in world units; World::circleVerlet.skin can be changed at any time.
+const double VERLET_SKIN = 4.0;
+
+// How far the Verlet cutoff is widened, as a fraction of the pair's radii, for pushes during a pass.
+const double VERLET_MARGIN = 0.5;
+
+// Suggested World::reorderInterval, in frames, for long runs; reordering changes which pairs are resolved first, so it is off by default.
+const int MORTON_REORDER_INTERVAL = 60;
+
+// With World::sleepingEnabled, a circle slower than SLEEP_SPEED (world units per second) for SLEEP_TIME seconds falls
+// asleep once every circle it touches is ready too; a contact closing faster than SLEEP_SPEED wakes a sleeping circle.
+const double SLEEP_SPEED = 15.0;
+const double SLEEP_TIME = 0.5;
+
+// Circles closer than this to touching, in world units, are in the same island when deciding who may sleep.
+const double SLEEP_CONTACT_SLOP = 1.0;
+
+// With CIRCLE_BROADPHASE_AUTO, scenes of up to this many circles per SIMD lane use the vectorized all-pairs pass and
+// larger ones the grid. Measured with the benchmark's circle-circle rows at the default density: roughly 150 circles
+// for SSE2 doubles, 200 for AVX doubles and 500 for AVX floats.
+const int ALL_PAIRS_CROSSOVER_PER_LANE = 64;
+
+// The parallel contact modes gather circle pairs up to this fraction of their radii's sum apart beyond touching, so
+// most pairs pushed together while the contacts are resolved are resolved too.
+const double PARALLEL_CONTACT_MARGIN = 0.1;
+
+// Contact batches smaller than this are resolved on the calling thread; waking the workers would cost more.
+const int MIN_PARALLEL_CONTACT_BATCH = 256;
+
+// How handleCircleCollisions finds candidate pairs. Every broadphase visits pairs in the all-pairs order.
+enum CircleBroadphase
+{
+    CIRCLE_BROADPHASE_ALL_PAIRS,
+    CIRCLE_BROADPHASE_GRID,
+    CIRCLE_BROADPHASE_SWEEP_AND_PRUNE,
+    CIRCLE_BROADPHASE_AABB_TREE,
+
+    // Neighbour lists reused across substeps until a body moves more than half the skin.
+    CIRCLE_BROADPHASE_VERLET,
+
+    // One grid per radius octave, for radii that vary by orders of magnitude.
+    CIRCLE_BROADPHASE_HIERARCHICAL_GRID,
+
+    // All-pairs up to World::allPairsCrossover circles, the grid above.
+    CIRCLE_BROADPHASE_AUTO
+};
+
+// How handleCollisions resolves contacts.
+enum ContactSolver
+{
+    // Overlapping bodies are pushed apart and given the closed-form elastic response, one pair at a time. Needs many
+    // substeps (NUMBER_OF_SIMULATIONS) to keep piles from sinking into each other.
+    CONTACT_SOLVER_PROJECTION,
+
+    // Warm-started sequential impulses with split-impulse position correction and per-pair restitution (ImpulseSolver.h).
+    // Stacks stay at rest with IMPULSE_SOLVER_SUBSTEPS substeps; contactParallelism does not apply to it.
+    CONTACT_SOLVER_IMPULSES,
+
+    // Extended position-based dynamics (XpbdSolver.h): contacts are compliant position constraints and velocities
+    // follow the corrections. Stacks stay at rest with XPBD_SUBSTEPS substeps; contactParallelism does not apply to it.
+    CONTACT_SOLVER_XPBD
+};
+
+// Suggested World::numberOfSimulations for CONTACT_SOLVER_IMPULSES and CONTACT_SOLVER_XPBD.
+const int IMPULSE_SOLVER_SUBSTEPS = 8;
+const int XPBD_SUBSTEPS = 4;
+
+// Restitution of new circles. At 1, piles need about twice IMPULSE_SOLVER_SUBSTEPS to come to rest.
+const double DEFAULT_RESTITUTION = 0.5;
+
+// How handleCircleCollisions spreads circle-circle contacts over World::contactThreads threads. The parallel modes
+// gather each substep's contacts with the grid, whatever the circle broadphase is.
+enum ContactParallelism
+{
+    // Every pair on the calling thread, in the all-pairs order.
+    CONTACT_PARALLELISM_NONE,
+
+    // Batches sharing no awake circle, one after another, each split over the threads. The order differs from the
+    // all-pairs one, so trajectories do too, but not between thread counts.
+    CONTACT_PARALLELISM_COLORED,
+
+    // Groups of circles touching each other, each solved by one thread in the all-pairs order, largest first. Only
+    // pairs that come into contact during the pass and were not gathered are left to the next substep.
+    CONTACT_PARALLELISM_ISLANDS
+};
+
+// How handleCapsuleCollisions finds the capsules near each circle, again in the all-pairs order.
+enum CapsuleBroadphase
+{
+    CAPSULE_BROADPHASE_ALL_PAIRS,
+
+    // Shares the circle sweep-and-prune lists, which also hold the capsule boxes.
+    CAPSULE_BROADPHASE_SWEEP_AND_PRUNE,
+
+    // O(log M) per circle; moving capsules are refitted by updateCapsulesStatuses.
+    CAPSULE_BROADPHASE_AABB_TREE
+};
+
+// The scalar the engine is instantiated with when a build does not ask for one explicitly.
+// Define PHYSICS_SCALAR_FLOAT to build the GUI in single precision; Headless and Benchmark choose at run time.
+#ifdef PHYSICS_SCALAR_FLOAT
+typedef float DefaultScalar;
+#else
+typedef double DefaultScalar;
+#endif
+
+// Everything about one circle, used to spawn and read back bodies; the world stores it split into BasicCircleArrays and CircleColdData.
+template <typename Scalar>
+struct BasicCircle
+{
+    Scalar posX;
+    Scalar posY;
+    Scalar radius;
+
+    Scalar mass;
+
+    double red;
+    double green;
+    double blue;
+
+    Scalar speedX;
+    Scalar speedY;
+
+    // Used by CONTACT_SOLVER_IMPULSES: 1 bounces back at the approach speed, 0 stops dead.
+    double restitution;
+
+    bool playerControlled;
+
+    BasicCircle() = default;
+
+    BasicCircle(Scalar posX, Scalar posY, Scalar radius, double red = 1.0, double green = 0.0, double blue = 0.0, Scalar mass = 1, Scalar speedX = 0, Scalar speedY = 0);
+};
+
+// Hot per-circle state, one contiguous aligned array per field. Everything the substep kernels touch lives here.
+template <typename Scalar>
+struct BasicCircleArrays
+{
+    AlignedVector<Scalar> posX;
+    AlignedVector<Scalar> posY;
+
+    AlignedVector<Scalar> speedX;
+    AlignedVector<Scalar> speedY;
+
+    AlignedVector<Scalar> radius;
+    AlignedVector<Scalar> mass;
+
+    int size() const;
+
+    void reserve(int capacity);
+
+    void add(const BasicCircle<Scalar>& circle);
+
+    // Moves the last circle into slot i and shrinks the arrays by one; capacity is kept for later spawns.
+    void swapRemove(int i);
+
+    // New index n gets the circle that was at order[n]; capacity is kept.
+    void permute(const std::vector<int>& order);
+
+    // Exchanges circles a and b in every array.
+    void swap(int a, int b);
+};
+
+// Cold per-circle data, indexed like BasicCircleArrays but only read by input handling and drawing.
+struct CircleColdData
+{
+    double red;
+    double green;
+    double blue;
+
+    double restitution;
+
+    bool playerControlled;
+};
+
+template <typename Scalar>
+struct BasicCapsule
+{
+    Scalar posX[2];
+    Scalar posY[2];
+    Scalar radius;
+
+    // Derived from the endpoints by updateGeometry: the unit axis from endpoint 1 towards endpoint 0, the distance
+    // between the endpoints and the box around the whole capsule.
+    Scalar axisX;
+    Scalar axisY;
+    Scalar length;
+
+    Aabb<Scalar> box;
+
+    // Kinematic velocity, about the middle of the segment: the capsule moves by it in every substep's integration and
+    // is not pushed back by circles. The player capsule's is set from the keys by handleInput.
+    Scalar speedX;
+    Scalar speedY;
+    Scalar angularSpeed;
+
+    double red;
+    double green;
+    double blue;
+
+    bool playerControlled;
+
+    BasicCapsule() = default;
+
+    BasicCapsule(Scalar pos0X, Scalar pos0Y, Scalar pos1X, Scalar pos1Y, Scalar radius, double red = 1.0, double green = 0.0, double blue = 0.0);
+
+    void rotate(Scalar angle);
+
+    // Must follow any change to the endpoints or the radius; rotate and World::refitCapsule call it.
+    void updateGeometry();
+
+    bool isMoving() const;
+
+    // Velocity of the capsule's surface at the point of the segment nearest to (x, y).
+    void surfaceSpeed(Scalar x, Scalar y, Scalar& surfaceSpeedX, Scalar& surfaceSpeedY) const;
+
+    // The box around everything the capsule covers while it moves for deltaTime.
+    Aabb<Scalar> sweptBox(Scalar deltaTime) const;
+
+    // Translates and rotates the endpoints by the velocity over deltaTime; the owner refits the capsule afterwards.
+    void move(Scalar deltaTime);
+};
+
+// Snapshot of the keys the simulation reacts to, so the world never has to talk to GLFW.
+struct InputState
+{
+    bool keyUp = false;
+    bool keyDown = false;
+    bool keyLeft = false;
+    bool keyRight = false;
+
+    bool keyB = false;
+    bool keyG = false;
+
+    bool keyW = false;
+    bool keyA = false;
+    bool keyS = false;
+    bool keyD = false;
+
+    bool keyQ = false;
+    bool keyE = false;
+};
+
+struct InputRecorder;
+struct InputPlayer;
+
+template <typename Scalar>
+struct BasicWorld
+{
+    // Dense body storage; circleRegistry / capsuleRegistry translate handles to indices in it.
+    BasicCircleArrays<Scalar> circles;
+    std::vector<CircleColdData> circleColdData;
+
+    std::vector<BasicCapsule<Scalar>> capsules;
+
+    BodyRegistry circleRegistry;
+    BodyRegistry capsuleRegistry;
+
+    // Size of the walled box centered on the origin, the window size unless a scene asks for more room.
+    Scalar width;
+    Scalar height;
+
+    Scalar currentGravityX;
+    Scalar currentGravityY;
+
+    bool changeGravitySourceButtonPressed;
+    bool changedGravityActive;
+    BodyHandle gravitySource;
+
+    int numberOfSimulations;
+
+    // When set, every frame's substep count comes from chooseSubsteps instead of numberOfSimulations. Off by default.
+    // The projection solver needs its substeps to hold piles up whatever their speed, so this pairs best with
+    // CONTACT_SOLVER_IMPULSES or CONTACT_SOLVER_XPBD.
+    bool adaptiveSubsteps;
+    Scalar substepSafetyFactor;
+    int minSubsteps;
+    int maxSubsteps;
+
+    // Substeps the last simulate call took.
+    int frameSubsteps;
+
+    // Multirate stepping, off by default. Every frame each awake circle gets a level k from its speed, with the same
+    // bound as adaptiveSubsteps, and from the levels of the circles it nearly touches; it then moves and collides only
+    // in the substeps divisible by 2^k, with a step of 2^k substeps. The coarsest level keeps at least minSubsteps
+    // steps per frame. Awake circles are kept sorted by level, so the circles of a substep are a prefix and the rest
+    // act as static obstacles, like sleeping circles. A circle that is hit, speeds up or nears a moving capsule is
+    // brought up to the current time and moved to level 0 for the rest of the frame, and so is a sleeping circle woken
+    // by the input or a contact. Every circle steps in the last substep, so all are in step between frames.
+    bool multirateStepping;
+
+    // Levels in the current frame. Level k holds awake circles circleLevelEnds[k - 1] (0 for k = 0) to
+    // circleLevelEnds[k] - 1; the last level ends with the awake circles and has no entry.
+    int multirateLevels;
+    std::vector<int> circleLevelEnds;
+
+    // While a substep runs with multirateStepping, numAwakeCircles is cut down to the circles taking part in it, and
+    // the awake count is kept here; substep is the current substep, from 1.
+    int multirateAwakeCircles;
+    int multirateSubstep;
+
+    // Scratch space of assignCircleLevels and promoteCircles.
+    std::vector<int> circleSpeedLevels;
+    std::vector<int> circleLevels;
+    std::vector<BodyHandle> circlesToPromote;
+
+    // Each taking part circle's step in substeps, for the xpbd solver and the sweeps.
+    std::vector<Scalar> circleStepMultipliers;
+
+    // Over the last frame: circle substeps actually taken, and circles moved to level 0.
+    long long multirateCircleSteps;
+    int promotedCircles;
+
+    // Continuous collision detection, off by default. Before every substep's move the fast circles are swept against
+    // the walls, the capsules and every circle near their path, and each pair that would meet only moves until it overlaps slightly,
+    // so the next substep's contact pass resolves the hit with whichever solver is selected.
+    bool continuousCollisions;
+
+    // Fraction of its motion each awake circle makes in the current substep.
+    std::vector<Scalar> circleMotionFraction;
+    std::vector<int> fastCircles;
+    std::vector<char> circleIsFast;
+
+    // Each awake circle's step in seconds for the current substep.
+    std::vector<Scalar> circleSteps;
+
+    // Every circle's path through the substep as the circle around it, binned in circleGrid to find the circles near
+    // each fast one.
+    std::vector<Scalar> circleSweptX;
+    std::vector<Scalar> circleSweptY;
+    std::vector<Scalar> circleSweptRadius;
+
+    // Over the last frame: swept circles (counted once per substep) and the hits that stopped them.
+    int sweptCircles;
+    int timeOfImpactHits;
+
+    // Over the last frame: circles that would have met a moving capsule during a substep, counted once per substep.
+    int movingCapsuleHits;
+
+    Scalar simulationDeltaTime;
+
+    // Frames simulated so far; input recording and replay are stamped with it.
+    int frameIndex;
+
+    CircleBroadphase circleBroadphase;
+    CapsuleBroadphase capsuleBroadphase;
+
+    // Largest circle count CIRCLE_BROADPHASE_AUTO resolves with all-pairs; ALL_PAIRS_CROSSOVER_PER_LANE times the
+    // build's SIMD lanes by default.
+    int allPairsCrossover;
+
+    // Bumped whenever circles or capsules are added, removed or reordered, so broadphases that persist between substeps know to rebuild.
+    int bodiesVersion;
+
+    // Every reorderInterval frames, circles are sorted along a Morton curve before the frame is simulated; 0 disables it.
+    int reorderInterval;
+
+    // Broadphase state; circleNeighbours is scratch space for one circle's candidates.
+    UniformGrid<Scalar> circleGrid;
+    SweepAndPrune<Scalar> circleSweep;
+    std::vector<int> circleNeighbours;
+
+    // Dynamic AABB trees; circleProxies[i] and capsuleProxies[j] are the leaves of circle i and capsule j.
+    AabbTree<Scalar> circleTree;
+    AabbTree<Scalar> capsuleTree;
+    std::vector<int> circleProxies;
+    std::vector<int> capsuleProxies;
+
+    VerletList<Scalar> circleVerlet;
+
+    HierarchicalGrid<Scalar> circleHierarchicalGrid;
+
+    // Sleeping, off by default. Awake circles are circles[0 .. numAwakeCircles - 1] and the sleeping ones follow, so
+    // integration, walls and both collision passes only walk the awake prefix. Sleeping circles keep still and act
+    // as static obstacles; they are woken by fast contacts, the B and G keys, arrow keys (the player circle) and
+    // a moving capsule passing over them.
+    bool sleepingEnabled;
+    int numAwakeCircles;
+
+    // Indexed like circles: how long each awake circle has been slower than SLEEP_SPEED, in seconds.
+    std::vector<Scalar> circleSleepTime;
+
+    // Sleeping circles hit during the current substep, woken once the pass is over so indices stay put meanwhile.
+    std::vector<int> circlesToWake;
+
+    UnionFind circleIslands;
+    std::vector<char> circleIslandReady;
+
+    ContactSolver contactSolver;
+
+    // Iterations per substep of CONTACT_SOLVER_IMPULSES and CONTACT_SOLVER_XPBD.
+    int contactIterations;
+
+    ImpulseSolver<Scalar> impulseSolver;
+
+    // Of CONTACT_SOLVER_XPBD, XPBD_CONTACT_COMPLIANCE unless set.
+    Scalar contactCompliance;
+
+    XpbdSolver<Scalar> xpbdSolver;
+
+    // Parallel contact resolution, off by default. contactThreads is one per hardware thread unless set; the results
+    // of either parallel mode do not depend on it.
+    ContactParallelism contactParallelism;
+    int contactThreads;
+
+    ContactColoring contactColoring;
+    ContactIslands contactIslands;
+    ThreadPool contactThreadPool;
+
+    // Per-thread scratch space: grid neighbours, gathered pairs (flattened) and sleeping circles to wake.
+    std::vector<std::vector<int>> threadNeighbours;
+    std::vector<std::vector<int>> threadContactPairs;
+    std::vector<std::vector<int>> threadCirclesToWake;
+
+    // When set, every substep's input is captured by inputRecorder, and inputPlayer replaces the live input.
+    InputRecorder* inputRecorder;
+    InputPlayer* inputPlayer;
+
+    BasicWorld();
+
+    BasicWorld(const BasicWorld&) = delete;
+    BasicWorld& operator=(const BasicWorld&) = delete;
+
+    BodyHandle addCircle(const BasicCircle<Scalar>& circle);
+    BodyHandle addCapsule(const BasicCapsule<Scalar>& capsule);
+
+    // Spawns all circles with one reservation; their handles are appended to handles if it is given.
+    void addCircles(const std::vector<BasicCircle<Scalar>>& newCircles, std::vector<BodyHandle>* handles = nullptr);
+
+    // Swap-remove despawns, O(1) each. Stale handles are ignored and reported by the return value.
+    bool removeCircle(BodyHandle handle);
+    bool removeCapsule(BodyHandle handle);
+
+    // Returns how many circles were actually despawned.
+    int removeCircles(const std::vector<BodyHandle>& handles);
+
+    BasicCircle<Scalar> getCircle(int i) const;
+
+    // Sorts every per-circle array by the Morton (Z-order) key of the circle's cell, so circles close in space are
+    // close in memory. Handles, and with them gravitySource, keep naming the same bodies.
+    void reorderCircles();
+
+    // Exchanges circles a and b everywhere, registry included.
+    void swapCircles(int a, int b);
+
+    // Puts old circle order[n] at index n everywhere, registry included.
+    void permuteCircles(const std::vector<int>& order);
+
+    // Moves the circles in circlesToWake to the awake prefix, or every circle, and resets their sleep timers.
+    void wakeCircles();
+    void wakeAllCircles();
+
+    // Once per frame: advances the sleep timers and puts to sleep every contact island whose circles all stayed slow
+    // for SLEEP_TIME. Islands are never put to sleep while a circle is the gravity source.
+    void updateSleeping(Scalar frameDeltaTime);
+
+    void handleInput(const InputState& input);
+    void handleCollisions();
+
+    // Calls addContact(a, b, key, normalX, normalY, separation, surfaceSpeed, restitution) for every awake circle's
+    // contacts with walls, capsules and circles closer than margin, in (circle, key) order, with key as in
+    // ImpulseContact. A pair of circles gets the larger of their restitutions, a circle against a wall or capsule its own.
+    template <typename AddContact>
+    void findContacts(const AddContact& addContact, Scalar margin);
+
+    void handleCollisionsImpulses();
+    void handleCollisionsXpbd();
+
+    void handleWallCollisions();
+    void handleCircleCollisions();
+    void handleCircleCollisionsAllPairs();
+    void handleCircleCollisionsGrid();
+    void handleCircleCollisionsSweep();
+    void handleCircleCollisionsTree();
+    void handleCircleCollisionsVerlet();
+    void handleCircleCollisionsHierarchicalGrid();
+    void handleCircleCollisionsColored();
+    void handleCircleCollisionsIslands();
+
+    // For the parallel modes: builds the grid and leaves the circle pairs within PARALLEL_CONTACT_MARGIN in
+    // threadContactPairs, which concatenated are in the all-pairs order.
+    void gatherCircleContacts();
+
+    // Resolves the pairs (pairA[k], pairB[k]) for k in [begin, end) in that order; pairB may be asleep, and the
+    // sleeping circles to wake go to wakeList.
+    void resolveCircleContacts(const int* pairA, const int* pairB, int begin, int end, std::vector<int>& wakeList);
+    void handleCapsuleCollisions();
+    void handleCapsuleCollisionsAllPairs();
+    void handleCapsuleCollisionsSweep();
+    void handleCapsuleCollisionsTree();
+
+    // Bring the trees in line with the bodies: a full rebuild after bodies were added or removed, otherwise circles
+    // that left their fat boxes are reinserted.
+    void updateCircleTree();
+    void updateCapsuleTree();
+
+    // Anything that moves capsule j outside of updateCapsulesStatuses must call this so its cached geometry and the
+    // capsule tree stay valid.
+    void refitCapsule(int j);
+
+    // Fills circleMotionFraction; see continuousCollisions.
+    void sweepFastCircles();
+
+    // Sweeps the awake circles near every moving capsule with their motion relative to its surface. A circle that
+    // would reach the capsule during the substep is shifted so that the integration leaves it just overlapping the
+    // capsule where they meet, and the next substep's contact pass resolves the hit with the surface velocity.
+    void sweepCirclesAgainstMovingCapsules();
+
+    // Moves the capsules by their kinematic velocities and refits the moving ones.
+    void updateCapsulesStatuses();
+
+    void updateCirclesStatuses();
+
+    // Moves circles begin .. end - 1 by deltaTime (times motionFraction[i] if it is given) and applies gravity and
+    // friction over deltaTime.
+    void integrateCircles(int begin, int end, Scalar deltaTime, const Scalar* motionFraction);
+
+    // Multirate stepping; see multirateStepping. assignCircleLevels sorts the awake circles by level at the start of a
+    // frame. levelSubsteps(i) is how many levels take part in substep i, and levelBegin / levelEnd bound a level.
+    void assignCircleLevels(double deltaTime);
+    int levelSubsteps(int substep) const;
+    int levelBegin(int level) const;
+    int levelEnd(int level) const;
+
+    // Fills circleStepMultipliers with 2^k for every taking part circle of level k and returns it; nullptr without
+    // multirateStepping.
+    const Scalar* levelStepMultipliers();
+
+    // Moves the circles in circlesToWake, which sit out the current substep or sleep, to level 0. The ones that sat
+    // out are first brought up to the time the others have reached.
+    void promoteCircles();
+
+    // Queues for promoteCircles every circle above level 0 that now moves more than the safety bound in one of its
+    // steps or may meet a moving capsule before its next step.
+    void promoteFastCircles();
+
+    // CFL bound for a frame of deltaTime: enough substeps that the fastest awake circle, plus what gravity adds over
+    // the frame, moves at most substepSafetyFactor times the smallest circle or capsule radius per substep, clamped to
+    // [minSubsteps, maxSubsteps]. Moving capsules are not counted: circles are swept against them. With
+    // multirateStepping the count is rounded up to a power of two, so that every level divides it.
+    int chooseSubsteps(double deltaTime) const;
+
+    // Advances the world by one frame, split into numberOfSimulations substeps of deltaTime / numberOfSimulations (rounded to Scalar),
+    // or into chooseSubsteps(deltaTime) substeps with adaptiveSubsteps.
+    // While inputPlayer has frames left, its recorded delta time and input replace the arguments.
+    void simulate(double deltaTime, const InputState& input);
+};
+
+// A circle at a random place in the world's box with a radius drawn uniformly from [minRadius, maxRadius], drawn from
+// rand() like the default scene. The draws are made in double and rounded once, so float and double worlds start from the same scene.
+template <typename Scalar>
+BasicCircle<Scalar> createRandomCircle(const BasicWorld<Scalar>& world, double minRadius = SPAWN_MIN_RADIUS, double maxRadius = SPAWN_MAX_RADIUS);
+
+// The scene main() used to build by hand: random circles (the first one player controlled) and capsules (the first one player controlled).
+template <typename Scalar>
+void createDefaultScene(BasicWorld<Scalar>& world, int numCircles, int numCapsules, unsigned int seed = 0, double minRadius = SPAWN_MIN_RADIUS, double maxRadius = SPAWN_MAX_RADIUS);
+
+// The engine at the build's DefaultScalar, which is what the GUI and most callers use.
+typedef BasicCircle<DefaultScalar> Circle;
+typedef BasicCircleArrays<DefaultScalar> CircleArrays;
+typedef BasicCapsule<DefaultScalar> Capsule;
+typedef BasicWorld<DefaultScalar> World;
@@ -0,0 +1,189 @@
+#include "XpbdSolver.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+template <typename Scalar>
+void XpbdSolver<Scalar>::clear()
+{
+    this->contacts.clear();
+}
+
+template <typename Scalar>
+void XpbdSolver<Scalar>::addContact(int a, int b, Scalar normalX, Scalar normalY, Scalar separation, Scalar surfaceSpeed, Scalar restitution)
+{
+    XpbdContact<Scalar> contact;
+
+    contact.a = a;
+    contact.b = b;
+
+    contact.normalX = normalX;
+    contact.normalY = normalY;
+
+    contact.separation = separation;
+    contact.distance = 0;
+
+    contact.surfaceSpeed = surfaceSpeed;
+
+    contact.restitution = restitution;
+
+    contact.normalSpeed = 0;
+    contact.lambda = 0;
+
+    this->contacts.push_back(contact);
+}
+
+template <typename Scalar>
+void XpbdSolver<Scalar>::solve(Scalar* posX, Scalar* posY, Scalar* speedX, Scalar* speedY, const Scalar* mass, int numDynamicBodies, Scalar deltaTime, int iterations, Scalar compliance, const Scalar* stepMultiplier)
+{
+    int numContacts = (int)this->contacts.size();
+
+    this->maxPenetration = 0;
+
+    this->startX.assign(posX, posX + numDynamicBodies);
+    this->startY.assign(posY, posY + numDynamicBodies);
+
+    for (int c = 0; c < numContacts; c++)
+    {
+        XpbdContact<Scalar>& contact = this->contacts[c];
+
+        int a = contact.a;
+        int b = contact.b;
+
+        if (b >= 0)
+        {
+            Scalar deltaX = posX[a] - posX[b];
+            Scalar deltaY = posY[a] - posY[b];
+
+            contact.distance = sqrt(deltaX * deltaX + deltaY * deltaY) - contact.separation;
+        }
+        else
+        {
+            contact.distance = posX[a] * contact.normalX + posY[a] * contact.normalY - contact.separation;
+        }
+
+        contact.normalSpeed = speedX[a] * contact.normalX + speedY[a] * contact.normalY;
+
+        // A static circle keeps still through the substep, whatever speed it has.
+        if (b >= 0 && b < numDynamicBodies)
+            contact.normalSpeed -= speedX[b] * contact.normalX + speedY[b] * contact.normalY;
+
+        contact.normalSpeed -= contact.surfaceSpeed;
+
+        this->maxPenetration = max(this->maxPenetration, -contact.separation);
+    }
+
+    // Compliance is scaled by the substep so the stiffness does not depend on it.
+    Scalar complianceStep = compliance / (deltaTime * deltaTime);
+
+    for (int iteration = 0; iteration < iterations; iteration++)
+    {
+        for (int c = 0; c < numContacts; c++)
+        {
+            XpbdContact<Scalar>& contact = this->contacts[c];
+
+            int a = contact.a;
+            int b = contact.b;
+
+            bool dynamicB = b >= 0 && b < numDynamicBodies;
+
+            Scalar violation;
+
+            if (b >= 0)
+            {
+                Scalar deltaX = posX[a] - posX[b];
+                Scalar deltaY = posY[a] - posY[b];
+
+                Scalar dist = sqrt(deltaX * deltaX + deltaY * deltaY);
+
+                // Circles on top of each other keep the normal they were found with.
+                if (dist > 0)
+                {
+                    contact.normalX = deltaX / dist;
+                    contact.normalY = deltaY / dist;
+                }
+
+                violation = dist - contact.distance;
+            }
+            else
+            {
+                violation = posX[a] * contact.normalX + posY[a] * contact.normalY - contact.distance;
+            }
+
+            if (violation >= 0)
+                continue;
+
+            Scalar inverseMassA = 1 / mass[a];
+            Scalar inverseMassB = dynamicB ? 1 / mass[b] : Scalar(0);
+
+            // The contact may push but never pull, so only the accumulated multiplier is clamped.
+            Scalar deltaLambda = (-violation - complianceStep * contact.lambda) / (inverseMassA + inverseMassB + complianceStep);
+
+            deltaLambda = max(contact.lambda + deltaLambda, Scalar(0)) - contact.lambda;
+            contact.lambda += deltaLambda;
+
+            posX[a] += contact.normalX * deltaLambda * inverseMassA;
+            posY[a] += contact.normalY * deltaLambda * inverseMassA;
+
+            if (dynamicB)
+            {
+                posX[b] -= contact.normalX * deltaLambda * inverseMassB;
+                posY[b] -= contact.normalY * deltaLambda * inverseMassB;
+            }
+        }
+    }
+
+    // Velocities follow the corrections. The owner has already moved the bodies by their speeds, so only the
+    // corrections are added.
+    for (int i = 0; i < numDynamicBodies; i++)
+    {
+        Scalar bodyDeltaTime = stepMultiplier != nullptr ? deltaTime * stepMultiplier[i] : deltaTime;
+
+        speedX[i] += (posX[i] - this->startX[i]) / bodyDeltaTime;
+        speedY[i] += (posY[i] - this->startY[i]) / bodyDeltaTime;
+    }
+
+    // The corrections also push overlapping bodies apart at whatever speed closes the overlap in one substep. Every
+    // contact that pushed gets the normal speed it should leave with instead: the bounce if it closed fast enough,
+    // none otherwise.
+    for (int c = 0; c < numContacts; c++)
+    {
+        XpbdContact<Scalar>& contact = this->contacts[c];
+
+        if (contact.lambda <= 0)
+            continue;
+
+        int a = contact.a;
+        int b = contact.b;
+
+        bool dynamicB = b >= 0 && b < numDynamicBodies;
+
+        Scalar inverseMassA = 1 / mass[a];
+        Scalar inverseMassB = dynamicB ? 1 / mass[b] : Scalar(0);
+
+        Scalar normalSpeed = speedX[a] * contact.normalX + speedY[a] * contact.normalY;
+
+        if (dynamicB)
+            normalSpeed -= speedX[b] * contact.normalX + speedY[b] * contact.normalY;
+
+        normalSpeed -= contact.surfaceSpeed;
+
+        Scalar targetSpeed = contact.normalSpeed < -Scalar(RESTITUTION_THRESHOLD) ? -contact.restitution * contact.normalSpeed : Scalar(0);
+
+        Scalar impulse = (targetSpeed - normalSpeed) / (inverseMassA + inverseMassB);
+
+        speedX[a] += contact.normalX * impulse * inverseMassA;
+        speedY[a] += contact.normalY * impulse * inverseMassA;
+
+        if (dynamicB)
+        {
+            speedX[b] -= contact.normalX * impulse * inverseMassB;
+            speedY[b] -= contact.normalY * impulse * inverseMassB;
+        }
+    }
+}
+
+template struct XpbdSolver<float>;
+template struct XpbdSolver<double>;
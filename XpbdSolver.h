@@ -0,0 +1,68 @@
+#pragma once
+
+#include <vector>
+
+// RESTITUTION_THRESHOLD is shared with the impulse solver.
+#include "ImpulseSolver.h"
+
+// Default contact compliance in world units per unit force: 0 is rigid, larger values let contacts give like springs.
+const double XPBD_CONTACT_COMPLIANCE = 0.0;
+
+// Contacts are gathered this far, in world units, before the bodies touch: the iterations skip them while they hold, and
+// catch them as soon as another correction pushes the bodies together.
+const double XPBD_CONTACT_MARGIN = 2.0;
+
+// One circle-versus-something position constraint for a substep. a is an awake circle; b is another circle, sleeping
+// ones included, or -1 for walls and capsules. A circle pair keeps its centres at least distance apart and takes its
+// normal from the current positions; a wall or capsule is the plane through the contact, normal . posA >= distance.
+template <typename Scalar>
+struct XpbdContact
+{
+    int a;
+    int b;
+
+    // From b to a.
+    Scalar normalX;
+    Scalar normalY;
+
+    // Negative while the bodies overlap, up to XPBD_CONTACT_MARGIN otherwise, as found.
+    Scalar separation;
+
+    Scalar distance;
+
+    // Normal speed of b's surface when b is a moving capsule, 0 otherwise; normal speeds are taken relative to it.
+    Scalar surfaceSpeed;
+
+    Scalar restitution;
+
+    // Relative normal speed before the substep, negative while closing.
+    Scalar normalSpeed;
+
+    // Accumulated over the iterations.
+    Scalar lambda;
+};
+
+// Extended position-based dynamics. Every substep the owner adds the contacts on the already moved positions and
+// calls solve: the iterations move the bodies until the constraints hold (or, with compliance, until they balance the
+// accumulated force), each circle's velocity then gains its correction over deltaTime, and a last pass sets the normal
+// speed of every contact that pushed to its restitution target.
+template <typename Scalar>
+struct XpbdSolver
+{
+    std::vector<XpbdContact<Scalar>> contacts;
+
+    // Positions before the iterations.
+    std::vector<Scalar> startX;
+    std::vector<Scalar> startY;
+
+    // Statistics of the last solve.
+    Scalar maxPenetration = 0;
+
+    void clear();
+
+    void addContact(int a, int b, Scalar normalX, Scalar normalY, Scalar separation, Scalar surfaceSpeed, Scalar restitution);
+
+    // Bodies numDynamicBodies and above are static, like b == -1. Every body has moved by deltaTime, or by
+    // deltaTime * stepMultiplier[i] if stepMultiplier is given, and its velocity gains its correction over that time.
+    void solve(Scalar* posX, Scalar* posY, Scalar* speedX, Scalar* speedY, const Scalar* mass, int numDynamicBodies, Scalar deltaTime, int iterations, Scalar compliance, const Scalar* stepMultiplier);
+};